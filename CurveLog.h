@@ -0,0 +1,18 @@
+#include <stdint.h>
+
+#define CURRENT_CURVELOGH_VERSION 1 // UPDATE THIS IF THE FILE LAYOUT CHANGES - adding or reordering columns only changes the schema
+
+#define CURVE_LOG_MAGIC 0x474C5054 // "TPLG" in a little endian file
+
+#define CURVE_LOG_FLOAT 'f' // 4 byte float
+#define CURVE_LOG_UINT 'u'  // 4 byte unsigned int
+
+// start of a binary curve log. followed by schema_size bytes of schema - for every column its type
+// character and then its null terminated name - and then records of num_fields 4 byte little endian values
+typedef struct {
+  uint32_t magic = CURVE_LOG_MAGIC;
+  uint16_t version = CURRENT_CURVELOGH_VERSION;
+  uint16_t num_fields;
+  uint16_t schema_size;
+  uint16_t reserved = 0;
+} curve_log_header;
@@ -0,0 +1,138 @@
+#include "Acquisition.h"
+
+#include <Arduino.h>
+
+#include "PressureSensor.h"
+#include "Thermocouples.h"
+#include "PTSweep.h"
+
+namespace Acquisition {
+
+namespace {
+struct Channel {
+  const char *name;
+  PressureSensor *pt; // PTs are read by the DMA sweep once running
+  Thermocouple *tc;   // TCs time their own conversions and serve cached values in between
+};
+
+Channel channels[ACQ_NUM_CHANNELS] = {
+    {"lox_valve_upstream", &PT::lox_valve_upstream, nullptr},
+    {"lox_valve_downstream", &PT::lox_valve_downstream, nullptr},
+    {"lox_venturi_differential", &PT::lox_venturi_differential, nullptr},
+    {"ipa_valve_upstream", &PT::ipa_valve_upstream, nullptr},
+    {"ipa_valve_downstream", &PT::ipa_valve_downstream, nullptr},
+    {"ipa_venturi_differential", &PT::ipa_venturi_differential, nullptr},
+    {"chamber", &PT::chamber, nullptr},
+    {"lox_valve_temperature", nullptr, &TC::lox_valve_temperature},
+    {"lox_venturi_temperature", nullptr, &TC::lox_venturi_temperature},
+};
+
+Sample samples[ACQ_NUM_CHANNELS];
+unsigned long stale[ACQ_NUM_CHANNELS];
+
+void set_sample(int i, float value, uint32_t time_us, bool valid) {
+  samples[i].value = value;
+  samples[i].time_us = time_us;
+  samples[i].valid = valid;
+  if (!valid) {
+    stale[i]++;
+  }
+}
+} // namespace
+
+void reset() {
+  if (PTSweep::pending()) {
+    PTSweep::finish(); // don't leave a sweep holding SPI1, aborts it if it hung
+  }
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    if (channels[i].tc) {
+      channels[i].tc->restart();
+      set_sample(i, channels[i].tc->getLastKelvin(), channels[i].tc->getSampleTime(), channels[i].tc->isValid());
+    }
+  }
+}
+
+void poll_tcs() {
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    const Channel &ch = channels[i];
+    if (!ch.tc) {
+      continue;
+    }
+    if (ch.tc->update()) {
+      bool valid = ch.tc->isValid();
+      set_sample(i, valid ? ch.tc->getLastKelvin() : samples[i].value, ch.tc->getSampleTime(), valid);
+    } else {
+      samples[i].valid = ch.tc->isValid(); // a fault poll may have changed it
+    }
+  }
+}
+
+Sensor_Data read(bool with_tcs) {
+  bool swept = PTSweep::pending();
+  bool fresh = !swept || PTSweep::finish(); // SPI1 is free either way, a timed out sweep is aborted
+
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    const Channel &ch = channels[i];
+    if (!ch.pt) {
+      continue;
+    }
+    if (swept) {
+      if (fresh) {
+        set_sample(i, ch.pt->getLastPressure(), PTSweep::sample_time_us(), ch.pt->getLastValid());
+      } else {
+        set_sample(i, samples[i].value, samples[i].time_us, false); // the sweep timed out, keep the previous sample
+      }
+    } else {
+      float value = ch.pt->getPressure(); // no sweep running, blocking read
+      set_sample(i, value, micros(), ch.pt->getLastValid());
+    }
+  }
+  if (with_tcs) {
+    poll_tcs();
+  }
+
+  Sensor_Data sd = {};
+  sd.ox.valve_upstream_pressure = samples[ACQ_LOX_VALVE_UPSTREAM].value;
+  sd.ox.valve_downstream_pressure = samples[ACQ_LOX_VALVE_DOWNSTREAM].value;
+  sd.ox.venturi_differential_pressure = samples[ACQ_LOX_VENTURI_DIFFERENTIAL].value;
+  sd.ox.valve_temperature = samples[ACQ_LOX_VALVE_TEMPERATURE].value;
+  sd.ox.venturi_temperature = samples[ACQ_LOX_VENTURI_TEMPERATURE].value;
+
+  sd.ipa.valve_upstream_pressure = samples[ACQ_IPA_VALVE_UPSTREAM].value;
+  sd.ipa.valve_downstream_pressure = samples[ACQ_IPA_VALVE_DOWNSTREAM].value;
+  sd.ipa.venturi_differential_pressure = samples[ACQ_IPA_VENTURI_DIFFERENTIAL].value;
+
+  sd.chamber_pressure = samples[ACQ_CHAMBER].value;
+
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    if (!samples[i].valid) {
+      sd.invalid |= 1u << i;
+    }
+    if (channels[i].pt && !channels[i].pt->getLastFresh()) {
+      sd.repeated |= 1u << i;
+    }
+  }
+  return sd;
+}
+
+void prefetch() {
+  PTSweep::start();
+}
+
+bool spi1_free() {
+  return !PTSweep::pending();
+}
+
+const Sample &latest(Acquisition_Channel channel) {
+  return samples[channel];
+}
+
+const char *channel_name(Acquisition_Channel channel) {
+  return channels[channel].name;
+}
+
+unsigned long stale_count(Acquisition_Channel channel) {
+  return stale[channel];
+}
+
+} // namespace Acquisition
@@ -0,0 +1,82 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+/*
+ * Acquisition.h
+ *
+ *  Description: Reads the PTs and TCs for the control loop at each sensor's own rate. The PTs are read
+ *  every tick, the MAX31856s only produce a new conversion about every 100 ms; the TC driver tracks
+ *  their conversion timing and only goes to the bus when a conversion is ready (or its fault register
+ *  is due), so read() hands back the cached value, with the time it was sampled, the rest of the time.
+ *  The two TCs are staggered so both never land on the same tick.
+ *
+ *  The PTs are read by a DMA sweep (PTSweep.h) that prefetch() starts once the tick is done with
+ *  SPI1, so they are clocked in while the CPU runs the controller, and read() in the next tick only
+ *  collects them. PT samples are therefore up to one tick old; their timestamps say exactly how old.
+ *
+ *  A read that fails - a PT frame with a bad crc, a sweep that timed out, a TC fault (open circuit,
+ *  out of range) - keeps the previous value, marks the sample invalid (Sensor_Data::invalid) and
+ *  counts it in stale_count(); the window comparators trip on a channel that stays invalid. A PT read
+ *  before its ADC finished a new conversion (DRDY clear in the status word) is valid but a repeat,
+ *  marked in Sensor_Data::repeated; PT_OSR keeps the ADCs converting faster than the tick so that
+ *  should not happen.
+ */
+
+#include <stdint.h>
+
+#include "valve_controller.h"
+
+enum Acquisition_Channel {
+  ACQ_LOX_VALVE_UPSTREAM,
+  ACQ_LOX_VALVE_DOWNSTREAM,
+  ACQ_LOX_VENTURI_DIFFERENTIAL,
+  ACQ_IPA_VALVE_UPSTREAM,
+  ACQ_IPA_VALVE_DOWNSTREAM,
+  ACQ_IPA_VENTURI_DIFFERENTIAL,
+  ACQ_CHAMBER,
+  ACQ_LOX_VALVE_TEMPERATURE,   // K
+  ACQ_LOX_VENTURI_TEMPERATURE, // K
+  ACQ_NUM_CHANNELS
+};
+
+struct Sample {
+  float value;
+  uint32_t time_us; // micros() when the value was read
+  bool valid;       // false if the read failed (crc error, sweep timeout) and value is the previous one
+};
+
+namespace Acquisition {
+
+// collects a pending PT sweep, the next read() samples every PT. reads the TCs and restarts their
+// staggered schedule, blocking - not from the control tick
+void reset();
+
+// samples the channels that are due and returns the latest value of every channel. the control tick
+// passes with_tcs = false and calls poll_tcs() once the DAC is written, so the TC polls (SPI_PRIORITY_LOW)
+// never delay the valve commands; its TC values are then the ones polled in the previous tick
+Sensor_Data read(bool with_tcs = true);
+
+// reads the TCs that have a conversion or fault check due
+void poll_tcs();
+
+// starts reading the PTs for the next read(). SPI1 is busy until then, call once the tick is done with it
+void prefetch();
+
+// false while a PT sweep is running, other SPI1 users (Zucrow DAC) must skip their transfer
+bool spi1_free();
+
+// latest sample of one channel
+const Sample &latest(Acquisition_Channel channel);
+
+const char *channel_name(Acquisition_Channel channel);
+
+// due reads of a channel that failed since boot
+unsigned long stale_count(Acquisition_Channel channel);
+
+inline bool is_valid(const Sensor_Data &sd, Acquisition_Channel channel) {
+  return !(sd.invalid & (1u << channel));
+}
+
+} // namespace Acquisition
+
+#endif
@@ -0,0 +1,109 @@
+#include "ControlLoop.h"
+
+#include <Arduino.h>
+
+#include "LoopProfiler.h"
+#include "Safety.h"
+#include "Router.h"
+#include "Telemetry.h"
+#include "Watchdog.h"
+
+#define CYCLES_PER_US (F_CPU_ACTUAL / 1000000)
+
+namespace ControlLoop {
+
+namespace {
+IntervalTimer timer;
+control_tick tick_fn;
+volatile bool running;
+volatile unsigned long tick_count;
+
+Loop_Stats stats;
+uint32_t last_start_cycles;
+
+void on_timer() {
+  uint32_t start = ARM_DWT_CYCCNT;
+  if (!running) {
+    return;
+  }
+
+  if (tick_count > 0) {
+    long jitter = (long)((start - last_start_cycles) / CYCLES_PER_US) - COMMAND_INTERVAL_US;
+    stats.min_jitter_us = min(stats.min_jitter_us, jitter);
+    stats.max_jitter_us = max(stats.max_jitter_us, jitter);
+  }
+  last_start_cycles = start;
+
+  LoopProfiler::current_stage = LoopProfiler::STAGE_TICK;
+  tick_fn(tick_count);
+  tick_count++;
+  Watchdog::feed(); // only a completed tick feeds it while the loop runs
+
+  unsigned long exec_us = (ARM_DWT_CYCCNT - start) / CYCLES_PER_US;
+  stats.max_exec_us = max(stats.max_exec_us, exec_us);
+  if (exec_us >= COMMAND_INTERVAL_US) {
+    stats.missed_deadlines++;
+  }
+  stats.ticks = tick_count;
+  LoopProfiler::record(LoopProfiler::STAGE_TICK, start);
+}
+
+// writes buffered log records to the SD card, sends telemetry and watches the console for a kill request
+void background() {
+  CurveLogger::service();
+  Telemetry::service();
+
+  if (COMMS_SERIAL.available() && COMMS_SERIAL.read() == 'k') {
+    Safety::request_serial_kill();
+  }
+  yield();
+}
+} // namespace
+
+void run(control_tick tick) {
+  tick_fn = tick;
+  tick_count = 0;
+  stats = {};
+  stats.min_jitter_us = COMMAND_INTERVAL_US;
+  stats.max_jitter_us = -COMMAND_INTERVAL_US;
+
+  running = true;
+  timer.priority(CONTROL_LOOP_PRIORITY);
+  timer.begin(on_timer, COMMAND_INTERVAL_US);
+
+  while (running) {
+    background();
+  }
+  timer.end();
+  background(); // write out whatever the last ticks logged
+}
+
+void stop() {
+  running = false;
+}
+
+Loop_Stats get_stats() {
+  noInterrupts();
+  Loop_Stats s = stats;
+  interrupts();
+  return s;
+}
+
+void print_stats() {
+  Loop_Stats s = get_stats();
+  Router::info_no_newline("Control loop: ");
+  Router::info_no_newline(s.ticks);
+  Router::info_no_newline(" ticks, ");
+  Router::info_no_newline(s.missed_deadlines);
+  Router::info(" missed deadlines.");
+
+  Router::info_no_newline("Tick jitter (us): ");
+  Router::info_no_newline(s.ticks > 1 ? s.min_jitter_us : 0);
+  Router::info_no_newline(" to ");
+  Router::info_no_newline(s.ticks > 1 ? s.max_jitter_us : 0);
+  Router::info_no_newline(", longest tick (us): ");
+  Router::info(s.max_exec_us);
+
+}
+
+} // namespace ControlLoop
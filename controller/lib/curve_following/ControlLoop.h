@@ -0,0 +1,45 @@
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+/*
+ * ControlLoop.h
+ *
+ *  Description: Fixed rate executive used by the curve follower. An IntervalTimer interrupt runs the
+ *  control tick every COMMAND_INTERVAL_US, independent of how long logging takes. Anything slow or
+ *  blocking (SD card, serial console) runs in the background - the code that called run() - and
+ *  gets its data from the tick through the curve log's ring buffer (LogWriter.h).
+ */
+
+#include "CurveLogger.h"
+
+#define COMMAND_INTERVAL_US 1000                                // control tick period
+#define LOG_INTERVAL_US 1000                                    // time between logged frames, every tick
+#define LOG_DECIMATION (LOG_INTERVAL_US / COMMAND_INTERVAL_US) // ticks per logged frame
+#define CONTROL_LOOP_PRIORITY 144                               // NVIC priority of the tick, DMA (128) and USB serial (112) preempt it
+
+// a control tick, called in interrupt context with the number of ticks since the loop started
+typedef void (*control_tick)(unsigned long tick);
+
+struct Loop_Stats {
+  unsigned long ticks;
+  unsigned long missed_deadlines; // ticks that were still running when the next one was due
+  long min_jitter_us;             // min/max deviation of the tick to tick interval from COMMAND_INTERVAL_US
+  long max_jitter_us;
+  unsigned long max_exec_us; // longest tick
+};
+
+namespace ControlLoop {
+
+// runs tick() every COMMAND_INTERVAL_US until it calls stop(), writing the curve log to the SD card
+// and watching for the serial kill request in between. returns once the loop has stopped
+void run(control_tick tick);
+
+// ends the loop after the current tick, call from the tick
+void stop();
+
+Loop_Stats get_stats();
+void print_stats();
+
+} // namespace ControlLoop
+
+#endif
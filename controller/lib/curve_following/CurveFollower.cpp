@@ -6,64 +6,56 @@
 #include "PressureSensor.h"
 #include "pi_controller.h"
 #include "Thermocouples.h"
+#include "Acquisition.h"
+#include "PTSweep.h"
+#include "ControlLoop.h"
 #include "CurveLogger.h"
+#include "FlightRecorder.h"
+#include "LoopProfiler.h"
+#include "Telemetry.h"
 #include "SDCard.h"
 #include "Safety.h"
+#include "Scheduler.h"
+#include "Watchdog.h"
 #include "Driver.h"
 #include "Loader.h"
 #include "Router.h"
 
-#define LOG_INTERVAL_US 5000
-#define COMMAND_INTERVAL_US 1000
+#define FEED_FORWARD_FILTER 0.05 // weight of each tick in the thrust curve velocity estimate, ~20 ms time constant
 
 namespace CurveFollower {
 
-/**
- * Performs linear interpolation between two values.
- * @param a The starting value.
- * @param b The ending value.
- * @param t0 The starting time.
- * @param t1 The ending time.
- * @param t The current time.
- * @return The interpolated value at the current time.
- */
-float lerp(float a, float b, float t0, float t1, float t) {
-  if (t <= t0)
-    return a;
-  if (t >= t1)
-    return b;
-  if (t0 == t1)
-    return b; // immediately get to b
-  return a + (b - a) * ((t - t0) / (t1 - t0));
-}
-
-// gets sensor data from PTs and TCs and performs safety checks
+// state shared by the control ticks of the curve being followed
+namespace {
+bool feed_forward = true; // send the expected valve velocity with every position command, kept between curves
+int segment;              // cursor into Loader::curve_segments, only ever moves forward
+int kill_reason;          // DONT_KILL or the KILLED_BY_* reason that ended the curve
+float start_pos_ox;       // valve positions held before the first thrust curve point
+float start_pos_fuel;
+float last_pos_ox; // previous closed loop position command, < 0 until the first one
+float last_pos_fuel;
+float vel_ox; // filtered velocity of the closed loop position commands (turns/s)
+float vel_fuel;
+uint32_t pt_latency_us; // PT sweep to valve commands in the current tick
+uint32_t dac_bus_us;    // SPI1 time of this tick's zucrow DAC update, 0 if the angles did not change
+} // namespace
+
+// gets the PT samples and the TC values polled in the previous tick (see Acquisition.h) and performs safety checks
 Sensor_Data get_sensor_data() {
-  Sensor_Data sd;
-
-  sd.ox.valve_upstream_pressure = PT::lox_valve_upstream.getPressure();
-  sd.ox.valve_downstream_pressure = PT::lox_valve_downstream.getPressure();
-  sd.ox.venturi_differential_pressure = PT::lox_venturi_differential.getPressure();
-  sd.ox.valve_temperature = TC::lox_valve_temperature.getTemperature_Kelvin();
-  sd.ox.venturi_temperature = TC::lox_venturi_temperature.getTemperature_Kelvin();
-
-  sd.ipa.valve_upstream_pressure = PT::ipa_valve_upstream.getPressure();
-  sd.ipa.valve_downstream_pressure = PT::ipa_valve_downstream.getPressure();
-  sd.ipa.venturi_differential_pressure = PT::ipa_venturi_differential.getPressure();
+  Sensor_Data sd = Acquisition::read(false);
 
-  sd.chamber_pressure = PT::chamber.getPressure();
+  using Acquisition::is_valid;
+  WindowComparators::lox_valve_upstream_pressure.check(sd.ox.valve_upstream_pressure, is_valid(sd, ACQ_LOX_VALVE_UPSTREAM));
+  WindowComparators::lox_valve_downstream_pressure.check(sd.ox.valve_downstream_pressure, is_valid(sd, ACQ_LOX_VALVE_DOWNSTREAM));
+  WindowComparators::lox_venturi_differential_pressure.check(sd.ox.venturi_differential_pressure, is_valid(sd, ACQ_LOX_VENTURI_DIFFERENTIAL));
+  WindowComparators::lox_valve_temperature.check(sd.ox.valve_temperature, is_valid(sd, ACQ_LOX_VALVE_TEMPERATURE));
+  WindowComparators::lox_venturi_temperature.check(sd.ox.venturi_temperature, is_valid(sd, ACQ_LOX_VENTURI_TEMPERATURE));
 
-  WindowComparators::lox_valve_upstream_pressure.check(sd.ox.valve_upstream_pressure);
-  WindowComparators::lox_valve_downstream_pressure.check(sd.ox.valve_downstream_pressure);
-  WindowComparators::lox_venturi_differential_pressure.check(sd.ox.venturi_differential_pressure);
-  WindowComparators::lox_valve_temperature.check(sd.ox.valve_temperature);
-  WindowComparators::lox_venturi_temperature.check(sd.ox.venturi_temperature);
+  WindowComparators::ipa_valve_upstream_pressure.check(sd.ipa.valve_upstream_pressure, is_valid(sd, ACQ_IPA_VALVE_UPSTREAM));
+  WindowComparators::ipa_valve_downstream_pressure.check(sd.ipa.valve_downstream_pressure, is_valid(sd, ACQ_IPA_VALVE_DOWNSTREAM));
+  WindowComparators::ipa_venturi_differential_pressure.check(sd.ipa.venturi_differential_pressure, is_valid(sd, ACQ_IPA_VENTURI_DIFFERENTIAL));
 
-  WindowComparators::ipa_valve_upstream_pressure.check(sd.ipa.valve_upstream_pressure);
-  WindowComparators::ipa_valve_downstream_pressure.check(sd.ipa.valve_downstream_pressure);
-  WindowComparators::ipa_venturi_differential_pressure.check(sd.ipa.venturi_differential_pressure);
-
-  WindowComparators::chamber_pressure.check(sd.chamber_pressure);
+  WindowComparators::chamber_pressure.check(sd.chamber_pressure, is_valid(sd, ACQ_CHAMBER));
   return sd;
 }
 
@@ -90,135 +82,275 @@ void print_all_sensors() {
   Router::info(" "); // newline
 }
 
+// curve time of a tick - the schedule, not the clock, so timing jitter never reaches the controller
+float tick_seconds(unsigned long tick) {
+  return tick * (COMMAND_INTERVAL_US / 1000000.0);
+}
+
+// moves `segment` forward to the segment containing t_us, returns false once the curve is over
+bool find_segment(uint32_t t_us) {
+  while (segment < Loader::num_segments && t_us >= Loader::curve_segments[segment].end_us) {
+    segment++;
+  }
+  return segment < Loader::num_segments;
+}
+
+// value of the current segment at t_us, holds the first point's value before the curve starts
+float curve_value(int channel, uint32_t t_us) {
+  const curve_segment &s = Loader::curve_segments[segment];
+  return s.value[channel] + s.slope[channel] * (t_us > s.start_us ? t_us - s.start_us : 0);
+}
+
+// slope of the current segment at t_us (per us), 0 while holding the first point before the curve starts
+float curve_slope(int channel, uint32_t t_us) {
+  const curve_segment &s = Loader::curve_segments[segment];
+  return t_us >= s.start_us ? s.slope[channel] : 0;
+}
+
+// filtered derivative of a closed loop position command (turns/s). thrust curves have no position
+// curve to take a slope from, so the feed-forward follows what the controller commands instead
+float command_velocity(float pos, float &last_pos, float &vel) {
+  if (last_pos >= 0) {
+    float raw = (pos - last_pos) * (1000000.0 / COMMAND_INTERVAL_US);
+    vel += (raw - vel) * FEED_FORWARD_FILTER;
+  }
+  last_pos = pos;
+  return vel;
+}
+
+// start of every tick: everything that needs SPI1 in latency order (PT frames, zucrow output, TC polls),
+// then SPI1 is handed to the PT sweep for the next tick so it runs while this tick computes
+Sensor_Data spi_stage() {
+  uint32_t stage_start = LoopProfiler::start(LoopProfiler::STAGE_SENSORS);
+  Sensor_Data sd = get_sensor_data();
+  LoopProfiler::record(LoopProfiler::STAGE_SENSORS, stage_start);
+
+  dac_bus_us = 0;
+  if (Acquisition::spi1_free()) {
+    stage_start = LoopProfiler::start(LoopProfiler::STAGE_ZUCROW);
+    dac_bus_us = ZucrowInterface::send_valve_angles_to_zucrow(Driver::loxODrive.position, Driver::ipaODrive.position);
+    LoopProfiler::record(LoopProfiler::STAGE_ZUCROW, stage_start);
+
+    stage_start = LoopProfiler::start(LoopProfiler::STAGE_TC_POLL);
+    Acquisition::poll_tcs();
+    LoopProfiler::record(LoopProfiler::STAGE_TC_POLL, stage_start);
+
+    Acquisition::prefetch();
+  }
+  return sd;
+}
+
+// every tick goes to the flight recorder, every LOG_DECIMATION ticks (and the last one) to the SD log
+void log_tick(unsigned long tick, float seconds, float thrust, Sensor_Data sd, bool last) {
+  uint32_t stage_start = LoopProfiler::start(LoopProfiler::STAGE_LOG);
+  Curve_Log_Frame frame = CurveLogger::capture_frame(seconds, segment, thrust, feed_forward, sd);
+  frame.pt_latency_us = pt_latency_us;
+  frame.dac_bus_us = dac_bus_us;
+  frame.kill_latency_us = Safety::kill_latency_us();
+  bool to_sd = last || tick % LOG_DECIMATION == 0;
+  const uint32_t *record = to_sd ? CurveLogger::log_frame(frame) : CurveLogger::pack(frame);
+  FlightRecorder::record(record);
+  Telemetry::publish(record);
+  LoopProfiler::record(LoopProfiler::STAGE_LOG, stage_start);
+}
+
+// shared end of every tick: logging and the kill check
+void finish_tick(unsigned long tick, float seconds, float thrust, Sensor_Data sd) {
+  uint32_t stage_start = LoopProfiler::start(LoopProfiler::STAGE_KILL_CHECK);
+  kill_reason = Safety::check_for_kill(seconds);
+  LoopProfiler::record(LoopProfiler::STAGE_KILL_CHECK, stage_start);
+  if (kill_reason != DONT_KILL) {
+    Safety::kill();
+    log_tick(tick, seconds, thrust, sd, true);
+    ControlLoop::stop();
+    return;
+  }
+
+  log_tick(tick, seconds, thrust, sd, false);
+}
+
+// positions in turns, velocities in turns/s - dropped when feed-forward is off
+void set_positions(float lox_pos, float ipa_pos, float lox_vel, float ipa_vel) {
+  if (!feed_forward) {
+    lox_vel = 0;
+    ipa_vel = 0;
+  }
+  uint32_t stage_start = LoopProfiler::start(LoopProfiler::STAGE_LOX_SETPOS);
+  Driver::loxODrive.setPos(lox_pos, lox_vel);
+  LoopProfiler::record(LoopProfiler::STAGE_LOX_SETPOS, stage_start);
+
+  stage_start = LoopProfiler::start(LoopProfiler::STAGE_IPA_SETPOS);
+  Driver::ipaODrive.setPos(ipa_pos, ipa_vel);
+  LoopProfiler::record(LoopProfiler::STAGE_IPA_SETPOS, stage_start);
+  pt_latency_us = micros() - Acquisition::latest(ACQ_CHAMBER).time_us; // every PT shares the sweep's time
+}
+
 /**
- * Follows an angle curve by interpolating between LOX and IPA positions.
+ * One control tick of an angle curve, interpolates between LOX and IPA positions.
  */
-void followAngleLerpCurve() {
-  lerp_point_angle *lac = Loader::lerp_angle_curve;
-  int kill_reason = DONT_KILL;
-  elapsedMicros timer = elapsedMicros();
-  unsigned long lastlog = timer;
-  unsigned long lastloop = timer;
+void angle_tick(unsigned long tick) {
+  uint32_t t_us = tick * COMMAND_INTERVAL_US;
+  if (!find_segment(t_us)) {
+    ControlLoop::stop();
+    return;
+  }
 
-  WindowComparators::reset();
+  float seconds = tick_seconds(tick);
+  float lox_pos = curve_value(0, t_us) / 360;
+  float ipa_pos = curve_value(1, t_us) / 360;
+  float lox_vel = curve_slope(0, t_us) * (1000000.0 / 360);
+  float ipa_vel = curve_slope(1, t_us) * (1000000.0 / 360);
 
-  long counter = 0;
-
-  for (int i = 0; i < Loader::header.num_points - 1; i++) {
-    while (timer / 1000000.0 < lac[i + 1].time) {
-      float seconds = timer / 1000000.0;
-      float lox_pos = lerp(lac[i].lox_angle, lac[i + 1].lox_angle, lac[i].time, lac[i + 1].time, seconds) / 360;
-      float ipa_pos = lerp(lac[i].ipa_angle, lac[i + 1].ipa_angle, lac[i].time, lac[i + 1].time, seconds) / 360;
-
-      Sensor_Data sd = get_sensor_data();
-      log_only(sd);
-
-      Driver::loxODrive.setPos(lox_pos);
-      Driver::ipaODrive.setPos(ipa_pos);
-
-      if (timer - lastlog > LOG_INTERVAL_US) {
-        lastlog += LOG_INTERVAL_US;
-        CurveLogger::log_curve_csv(seconds, i, -1, sd);
-      }
-      counter++;
-
-      ZucrowInterface::send_valve_angles_to_zucrow(Driver::loxODrive.position, Driver::ipaODrive.position);
-      kill_reason = Safety::check_for_kill(seconds);
-      if (kill_reason != DONT_KILL) {
-        Safety::kill_response(kill_reason);
-        CurveLogger::log_curve_csv(seconds, i, -1, sd);
-        break;
-      }
-
-      unsigned long target_slp = COMMAND_INTERVAL_US - (timer - lastloop);
-      delayMicroseconds(target_slp < COMMAND_INTERVAL_US ? target_slp : 0); // don't delay for too long
-      lastloop += COMMAND_INTERVAL_US;
-    }
-    if (kill_reason != DONT_KILL) {
-      break;
-    }
+  Sensor_Data sd = spi_stage();
+  log_only(sd);
+
+  set_positions(lox_pos, ipa_pos, lox_vel, ipa_vel);
+  Driver::loxODrive.updateTelemetry();
+  Driver::ipaODrive.updateTelemetry();
+
+  finish_tick(tick, seconds, -1, sd);
+}
+
+/**
+ * One control tick of a thrust curve, interpolates between thrust values.
+ */
+void thrust_tick(unsigned long tick) {
+  uint32_t t_us = tick * COMMAND_INTERVAL_US;
+  if (!find_segment(t_us)) {
+    ControlLoop::stop();
+    return;
   }
-  Router::info_no_newline("Finished ");
-  Router::info_no_newline(counter);
-  Router::info(" loop iterations.");
+
+  float seconds = tick_seconds(tick);
+  float thrust = curve_value(0, t_us);
+
+  Sensor_Data sd = spi_stage();
+
+  if (t_us < Loader::curve_segments[0].start_us) {
+    log_only(sd);
+    set_positions(start_pos_ox, start_pos_fuel, 0, 0);
+  } else {
+    // a stale position can't say whether the valve keeps up, stop integrating until it is current again
+    float lox_acc_factor = Driver::loxODrive.encoderStale() ? 0 : tracking_acc_factor(Driver::loxODrive.getLastPosCmd(), 0.25 - Driver::loxODrive.last_enc_msg.read().Pos_Estimate);
+    float ipa_acc_factor = Driver::ipaODrive.encoderStale() ? 0 : tracking_acc_factor(Driver::ipaODrive.getLastPosCmd(), 0.25 - Driver::ipaODrive.last_enc_msg.read().Pos_Estimate);
+
+    float angle_ox;
+    float angle_fuel;
+    uint32_t stage_start = LoopProfiler::start(LoopProfiler::STAGE_CONTROL);
+    closed_loop_thrust_control(thrust, sd, lox_acc_factor, ipa_acc_factor, tick * COMMAND_INTERVAL_US / 1000, &angle_ox, &angle_fuel);
+    LoopProfiler::record(LoopProfiler::STAGE_CONTROL, stage_start);
+    float pos_ox = angle_ox / 360;
+    float pos_fuel = angle_fuel / 360;
+    set_positions(pos_ox, pos_fuel, command_velocity(pos_ox, last_pos_ox, vel_ox), command_velocity(pos_fuel, last_pos_fuel, vel_fuel));
+  }
+  Driver::loxODrive.updateTelemetry();
+  Driver::ipaODrive.updateTelemetry();
+
+  finish_tick(tick, seconds, thrust, sd);
+}
+
+// one flight recorder entry of the wait for the go signal, the valves hold their start position
+void record_waiting() {
+  Sensor_Data sd = Acquisition::read();
+  Driver::loxODrive.updateTelemetry();
+  Driver::ipaODrive.updateTelemetry();
+  const uint32_t *record = CurveLogger::pack(CurveLogger::capture_frame(0, 0, -1, feed_forward, sd));
+  FlightRecorder::record(record);
+  Telemetry::publish(record);
+  Telemetry::service();
 }
 
 /**
- * Follows a thrust curve by interpolating between thrust values.
+ * Follows the loaded curve on the fixed rate control loop, then reports how it went.
  */
-void followThrustLerpCurve(float start_angle_ox, float start_angle_fuel) {
-  lerp_point_thrust *ltc = Loader::lerp_thrust_curve;
-  int kill_reason = DONT_KILL;
-  elapsedMicros timer = elapsedMicros();
-  unsigned long lastlog = timer;
-  unsigned long lastloop = timer;
-
-  ClosedLoopControllers::reset();
-  WindowComparators::reset();
+void followCurve(float start_angle_ox, float start_angle_fuel) {
+  segment = 0;
+  kill_reason = DONT_KILL;
+  start_pos_ox = start_angle_ox / 360;
+  start_pos_fuel = start_angle_fuel / 360;
+  last_pos_ox = -1;
+  last_pos_fuel = -1;
+  vel_ox = 0;
+  vel_fuel = 0;
+  pt_latency_us = 0;
+  dac_bus_us = 0;
+  Driver::loxODrive.clipCount = 0;
+  Driver::ipaODrive.clipCount = 0;
+  unsigned long crc_errors = PT::crc_error_count();
+  unsigned long repeated = PT::repeated_sample_count();
+  unsigned long stale[ACQ_NUM_CHANNELS];
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    stale[i] = Acquisition::stale_count((Acquisition_Channel)i);
+  }
+  unsigned long sweep_timeouts = PTSweep::timeouts;
 
-  long counter = 0;
-
-  for (int i = 0; i < Loader::header.num_points - 1; i++) {
-    while (timer / 1000000.0 < ltc[i + 1].time) {
-      float seconds = timer / 1000000.0;
-      float thrust = lerp(ltc[i].thrust, ltc[i + 1].thrust, ltc[i].time, ltc[i + 1].time, seconds);
-
-      Sensor_Data sd = get_sensor_data();
-
-      if (seconds < ltc[0].time) {
-        log_only(sd);
-        Driver::loxODrive.setPos(start_angle_ox / 360);
-        Driver::ipaODrive.setPos(start_angle_fuel / 360);
-      } else {
-        float lox_angle_delta = abs(Driver::loxODrive.getLastPosCmd() - (0.25 - Driver::loxODrive.last_enc_msg.Pos_Estimate));
-        float lox_acc_factor = max(0, 1 - (lox_angle_delta / (8.0 / 360)));
-
-        float ipa_angle_delta = abs(Driver::ipaODrive.getLastPosCmd() - (0.25 - Driver::ipaODrive.last_enc_msg.Pos_Estimate));
-        float ipa_acc_factor = max(0, 1 - (ipa_angle_delta / (8.0 / 360)));
-
-        float angle_ox;
-        float angle_fuel;
-        closed_loop_thrust_control(thrust, sd, lox_acc_factor, ipa_acc_factor, &angle_ox, &angle_fuel);
-        Driver::loxODrive.setPos(angle_ox / 360);
-        Driver::ipaODrive.setPos(angle_fuel / 360);
-      }
-
-      if (timer - lastlog > LOG_INTERVAL_US) {
-        lastlog += LOG_INTERVAL_US;
-        CurveLogger::log_curve_csv(seconds, i, thrust, sd);
-      }
-      counter++;
-
-      ZucrowInterface::send_valve_angles_to_zucrow(Driver::loxODrive.position, Driver::ipaODrive.position);
-      kill_reason = Safety::check_for_kill(seconds);
-      if (kill_reason != DONT_KILL) {
-        Safety::kill_response(kill_reason);
-        CurveLogger::log_curve_csv(seconds, i, thrust, sd);
-        break;
-      }
-
-      unsigned long target_slp = COMMAND_INTERVAL_US - (timer - lastloop);
-      delayMicroseconds(target_slp < COMMAND_INTERVAL_US ? target_slp : 0); // don't delay for too long
-      lastloop += COMMAND_INTERVAL_US;
-    }
-    if (kill_reason != DONT_KILL) {
-      break;
-    }
+  if (Loader::header.is_thrust) {
+    ClosedLoopControllers::reset();
+  }
+  WindowComparators::reset();
+  Safety::clear_serial_kill();
+  Safety::arm_zucrow_abort();
+  LoopProfiler::reset();
+  Acquisition::reset();
+
+  FlightRecorder::trigger();
+  ControlLoop::run(Loader::header.is_thrust ? thrust_tick : angle_tick);
+  Watchdog::disarm(); // nothing feeds it through the summary and close_curve_log() below
+  Safety::disarm_zucrow_abort();
+  Acquisition::reset(); // collects the last prefetch, SPI1 is free for blocking use again
+
+  if (kill_reason != DONT_KILL) {
+    Safety::print_kill_reason(kill_reason);
   }
 
   Router::info_no_newline("Finished ");
-  Router::info_no_newline(counter);
+  Router::info_no_newline(ControlLoop::get_stats().ticks);
   Router::info(" loop iterations.");
+  ControlLoop::print_stats();
+
+  if (Driver::loxODrive.clipCount || Driver::ipaODrive.clipCount) {
+    Router::info_no_newline("Clipped position commands (lox, ipa): ");
+    Router::info_no_newline(Driver::loxODrive.clipCount);
+    Router::info_no_newline(", ");
+    Router::info(Driver::ipaODrive.clipCount);
+  }
+  if (PTSweep::timeouts != sweep_timeouts) {
+    Router::info_no_newline("PT sweep timeouts: ");
+    Router::info(PTSweep::timeouts - sweep_timeouts);
+  }
+  if (PT::crc_error_count() != crc_errors) {
+    Router::info_no_newline("PT crc errors: ");
+    Router::info(PT::crc_error_count() - crc_errors);
+  }
+  if (PT::repeated_sample_count() != repeated) {
+    Router::info_no_newline("PT samples read before a new conversion (raise the data rate with pt_osr): ");
+    Router::info(PT::repeated_sample_count() - repeated);
+  }
+  for (int i = 0; i < ACQ_NUM_CHANNELS; i++) {
+    unsigned long n = Acquisition::stale_count((Acquisition_Channel)i) - stale[i];
+    if (n) {
+      Router::info_no_newline("Invalid samples, ");
+      Router::info_no_newline(Acquisition::channel_name((Acquisition_Channel)i));
+      Router::info_no_newline(": ");
+      Router::info(n);
+    }
+  }
+}
+
+void toggle_feed_forward() {
+  feed_forward = !feed_forward;
+  Router::info(feed_forward ? "Velocity feed-forward: on" : "Velocity feed-forward: off");
 }
 
 // init CurveFollower and add relevant router cmds
 void begin() {
   Router::add({print_all_sensors, "print_sensors"});
+  Router::add({toggle_feed_forward, "toggle_feed_forward"});
   Router::add({arm, "arm"});
 }
 
 // prompt user for log file name, then follow curve
-void arm() {
+void arm_and_follow() {
   if (!Loader::loaded_curve) {
     Router::info("ARMING FAILURE: no curve loaded.");
     return;
@@ -272,51 +404,67 @@ void arm() {
   Router::info("ARMING STATUS: Moving odrives, monitor valve angle readout.");
   Driver::loxODrive.setPos(lox_start / 360);
   Driver::ipaODrive.setPos(ipa_start / 360);
-  ZucrowInterface::report_angles_for_five_seconds();
+  ZucrowInterface::report_angles();
 
   // filenames use DOS 8.3 standard
-  Router::info_no_newline("Enter log filename (1-8 chars + '.' + 3 chars): ");
+  Router::info_no_newline("Enter log filename (1-8 chars + '.LOG', binary - decode with log_decoder): ");
   String log_file_name = Router::read(50);
-  CurveLogger::create_curve_log(log_file_name.c_str()); // lower case files have issues on teensy
+  uint32_t curve_us = Loader::curve_segments[Loader::num_segments - 1].end_us;
+  CurveLogger::create_curve_log(log_file_name.c_str(), curve_us / LOG_INTERVAL_US + 2); // lower case files have issues on teensy
 
   Router::info_no_newline("ARMING COMPLETE. Type `y` and press enter to confirm. ");
-  String final_check_str = Router::read(50);
+  String final_check_str = Router::read_typed(50); // never from inline arguments
   if (final_check_str != "y") {
     Router::info("ARMING FAILURE: Cancelled by operator.");
     CurveLogger::close_curve_log();
     return;
   }
 
+  FlightRecorder::start(curve_us / COMMAND_INTERVAL_US + 2);
+  // armed only now: the log preallocation and the recorder's EXTMEM clearing above take as long as the
+  // card and the curve length make them, unbounded next to WATCHDOG_KILL_MS
+  Watchdog::arm();
   ZucrowInterface::send_ok_to_zucrow(); // tell zucrow we are ready to go
 
 #ifdef ENABLE_ZUCROW_SAFETY
-  elapsedMillis sensor_print_timer = elapsedMillis();
-  unsigned long last_print = sensor_print_timer;
-
-  while (ZucrowInterface::check_sync_from_zucrow() != ZUCROW_SYNC_RUNNING) {
+  Acquisition::reset();
+  int record_task = Scheduler::every("pre_trigger", COMMAND_INTERVAL_US, record_waiting, COMMAND_INTERVAL_US / 2);
+  int print_task = Scheduler::every("wait_print", 1000000, [] {
+    Router::info("Waiting for go signal from Zucrow... ");
+    print_all_sensors();
+  });
+
+  const char *abort_reason = nullptr;
+  Scheduler::run_until([&] { // wait until zucrow gives us the go
     if (COMMS_SERIAL.available() && COMMS_SERIAL.read() == 'k') {
-      Router::info("ARMING FAILURE: Aborted by operator.");
-      return;
-    }
-    if (ZucrowInterface::check_fault_from_zucrow()) {
-      Router::info("ARMING FAILURE: Zucrow abort line in abort state.");
-      return;
-    }
-
-    if (sensor_print_timer - last_print >= 1000) {
-      Router::info("Waiting for go signal from Zucrow... ");
-      print_all_sensors();
-      last_print = sensor_print_timer;
+      abort_reason = "ARMING FAILURE: Aborted by operator.";
+    } else if (ZucrowInterface::check_fault_from_zucrow()) {
+      abort_reason = "ARMING FAILURE: Zucrow abort line in abort state.";
     }
-  }; // wait until zucrow gives us the go
+    return abort_reason != nullptr || ZucrowInterface::check_sync_from_zucrow() == ZUCROW_SYNC_RUNNING;
+  });
+  Scheduler::cancel(record_task);
+  Scheduler::cancel(print_task);
+  if (abort_reason) {
+    Router::info(abort_reason);
+    Watchdog::disarm(); // nothing feeds it through the flush
+    CurveLogger::close_curve_log(); // keeps the pre-trigger records and trims the preallocation
+    return;
+  }
 #endif
 
   ZucrowInterface::send_sync_to_zucrow(TEENSY_SYNC_RUNNING);
-  Loader::header.is_thrust ? followThrustLerpCurve(lox_start, ipa_start) : followAngleLerpCurve();
+  followCurve(lox_start, ipa_start);
   ZucrowInterface::send_sync_to_zucrow(TEENSY_SYNC_IDLE);
 
   Router::info("Finished following curve!");
   CurveLogger::close_curve_log();
 }
 
+// the watchdog supervises arm_and_follow() from the operator's confirmation to the end of the control loop
+void arm() {
+  arm_and_follow();
+  Watchdog::disarm();
+}
+
 } // namespace CurveFollower
\ No newline at end of file
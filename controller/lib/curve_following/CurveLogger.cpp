@@ -1,68 +1,257 @@
 #include "CurveLogger.h"
 
+#include <CurveLog.h>
+
 #include "pi_controller.h"
 #include "CString.h"
 #include "Driver.h"
 #include "Router.h"
-#include "SDCard.h"
 
 namespace CurveLogger {
 
-File odriveLogFile;
-CString<400> curveTelemCSV;
-
-#define LOG_HEADER ("time,phase,thrust_cmd,lox_pos_cmd,ipa_pos_cmd,"                                               \
-                    "lox_pos,lox_vel,lox_voltage,lox_current,"                                                     \
-                    "ipa_pos,ipa_vel,ipa_voltage,ipa_current,"                                                     \
-                    "chamber_pressure,"                                                                            \
-                    "lox_valve_upstream_pressure,lox_valve_downstream_pressure,lox_venturi_differential_pressure," \
-                    "lox_venturi_temperature,lox_valve_temperature,"                                               \
-                    "ipa_valve_upstream_pressure,ipa_valve_downstream_pressure,ipa_venturi_differential_pressure," \
-                    "chamber_pressure_controller_p_component,chamber_pressure_controller_i_component,"             \
-                    "lox_angle_controller_p_component,lox_angle_controller_i_component,"                           \
-                    "ipa_angle_controller_p_component,ipa_angle_controller_i_component,"                           \
-                    "lox_mdot,ipa_mdot,ol_lox_mdot,ol_ipa_mdot,ol_lox_angle,ol_ipa_angle,"                         \
-                    "lox_valve_downstream_pressure_calc,ipa_valve_downstream_pressure_calc")
-
-// logs time, phase, thrust, and sensor data in .csv format
-int print_counter = 0;
-void log_curve_csv(float time, int phase, float thrust, Sensor_Data sd) {
-  Controller_State cs = ClosedLoopControllers::getState();
-  curveTelemCSV.clear();
-  curveTelemCSV << time << "," << phase << "," << thrust << "," << Driver::loxODrive.getLastPosCmd() << "," << Driver::ipaODrive.getLastPosCmd() << ","
-                << Driver::loxODrive.getTelemetryCSV() << "," << Driver::ipaODrive.getTelemetryCSV() << ","
-                << sd.chamber_pressure << ","
-                << sd.ox.valve_upstream_pressure << "," << sd.ox.valve_downstream_pressure << "," << sd.ox.venturi_differential_pressure << ","
-                << sd.ox.venturi_temperature << "," << sd.ox.valve_temperature << ","
-                << sd.ipa.valve_upstream_pressure << "," << sd.ipa.valve_downstream_pressure << "," << sd.ipa.venturi_differential_pressure << ","
-                << cs.chamber_pressure_controller_p_component << "," << cs.chamber_pressure_controller_i_component << ","
-                << cs.lox_angle_controller_p_component << "," << cs.lox_angle_controller_i_component << ","
-                << cs.ipa_angle_controller_p_component << "," << cs.ipa_angle_controller_i_component << ","
-                << vc_state.measured_lox_mdot << "," << vc_state.measured_ipa_mdot << ","
-                << vc_state.ol_lox_mdot << "," << vc_state.ol_ipa_mdot << "," << vc_state.ol_lox_angle << "," << vc_state.ol_ipa_angle << ","
-                << vc_state.ox_valve_downstream_calc << "," << vc_state.ipa_valve_downstream_calc;
-
-  odriveLogFile.println(curveTelemCSV.str);
-  odriveLogFile.flush();
-
-  print_counter++;
-  if (print_counter % 10 == 0) {
-    curveTelemCSV.clear();
-    curveTelemCSV << time << "  " << thrust << "  " << vc_state.measured_lox_mdot << "  " << vc_state.measured_ipa_mdot;
-    curveTelemCSV.print();
+LogWriter log_writer(CURVE_LOG_BUFFER_SIZE);
+CString<80> consolePrint;
+float last_console_print; // curve time of the last console line
+uint32_t last_sync_ms;    // millis() of the last sync of the curve log
+
+// progress line handed from the tick to the background, the tick only fills it while it is free
+struct Console_Line {
+  float time;
+  float thrust;
+  float lox_mdot;
+  float ipa_mdot;
+};
+Console_Line console_line;
+volatile bool console_line_pending;
+
+// one column of the binary log: its name in the schema and how to get its value from a frame
+struct Log_Column {
+  const char *name;
+  char type;
+  float (*as_float)(const Curve_Log_Frame &f);   // CURVE_LOG_FLOAT columns
+  uint32_t (*as_uint)(const Curve_Log_Frame &f); // CURVE_LOG_UINT columns
+};
+
+#define FLOAT_COLUMN(name, value) {name, CURVE_LOG_FLOAT, [](const Curve_Log_Frame &f) -> float { return value; }, nullptr}
+#define UINT_COLUMN(name, value) {name, CURVE_LOG_UINT, nullptr, [](const Curve_Log_Frame &f) -> uint32_t { return value; }}
+
+// the schema written at the start of every log, decoded logs have these columns in this order
+const Log_Column columns[] = {
+    FLOAT_COLUMN("time", f.time),
+    UINT_COLUMN("phase", f.phase),
+    FLOAT_COLUMN("thrust_cmd", f.thrust),
+    FLOAT_COLUMN("lox_pos_cmd", f.lox.pos_cmd),
+    FLOAT_COLUMN("ipa_pos_cmd", f.ipa.pos_cmd),
+    FLOAT_COLUMN("lox_pos", f.lox.position),
+    FLOAT_COLUMN("lox_vel", f.lox.velocity),
+    FLOAT_COLUMN("lox_voltage", f.lox.voltage),
+    FLOAT_COLUMN("lox_current", f.lox.current),
+    FLOAT_COLUMN("ipa_pos", f.ipa.position),
+    FLOAT_COLUMN("ipa_vel", f.ipa.velocity),
+    FLOAT_COLUMN("ipa_voltage", f.ipa.voltage),
+    FLOAT_COLUMN("ipa_current", f.ipa.current),
+    FLOAT_COLUMN("chamber_pressure", f.sd.chamber_pressure),
+    FLOAT_COLUMN("lox_valve_upstream_pressure", f.sd.ox.valve_upstream_pressure),
+    FLOAT_COLUMN("lox_valve_downstream_pressure", f.sd.ox.valve_downstream_pressure),
+    FLOAT_COLUMN("lox_venturi_differential_pressure", f.sd.ox.venturi_differential_pressure),
+    FLOAT_COLUMN("lox_venturi_temperature", f.sd.ox.venturi_temperature),
+    FLOAT_COLUMN("lox_valve_temperature", f.sd.ox.valve_temperature),
+    FLOAT_COLUMN("ipa_valve_upstream_pressure", f.sd.ipa.valve_upstream_pressure),
+    FLOAT_COLUMN("ipa_valve_downstream_pressure", f.sd.ipa.valve_downstream_pressure),
+    FLOAT_COLUMN("ipa_venturi_differential_pressure", f.sd.ipa.venturi_differential_pressure),
+    UINT_COLUMN("invalid_sensors", f.sd.invalid), // bit 1 << Acquisition_Channel per repeated older value
+    UINT_COLUMN("repeated_pt_samples", f.sd.repeated),
+    UINT_COLUMN("pt_latency_us", f.pt_latency_us),
+    UINT_COLUMN("kill_latency_us", f.kill_latency_us),
+    UINT_COLUMN("dac_bus_us", f.dac_bus_us),
+    FLOAT_COLUMN("chamber_pressure_controller_p_component", f.cs.chamber_pressure_controller_p_component),
+    FLOAT_COLUMN("chamber_pressure_controller_i_component", f.cs.chamber_pressure_controller_i_component),
+    FLOAT_COLUMN("lox_angle_controller_p_component", f.cs.lox_angle_controller_p_component),
+    FLOAT_COLUMN("lox_angle_controller_i_component", f.cs.lox_angle_controller_i_component),
+    FLOAT_COLUMN("ipa_angle_controller_p_component", f.cs.ipa_angle_controller_p_component),
+    FLOAT_COLUMN("ipa_angle_controller_i_component", f.cs.ipa_angle_controller_i_component),
+    FLOAT_COLUMN("lox_mdot", f.vc.measured_lox_mdot),
+    FLOAT_COLUMN("ipa_mdot", f.vc.measured_ipa_mdot),
+    FLOAT_COLUMN("ol_lox_mdot", f.vc.ol_lox_mdot),
+    FLOAT_COLUMN("ol_ipa_mdot", f.vc.ol_ipa_mdot),
+    FLOAT_COLUMN("ol_lox_angle", f.vc.ol_lox_angle),
+    FLOAT_COLUMN("ol_ipa_angle", f.vc.ol_ipa_angle),
+    FLOAT_COLUMN("lox_valve_downstream_pressure_calc", f.vc.ox_valve_downstream_calc),
+    FLOAT_COLUMN("ipa_valve_downstream_pressure_calc", f.vc.ipa_valve_downstream_calc),
+    UINT_COLUMN("feed_forward", f.feed_forward),
+    FLOAT_COLUMN("lox_vel_ff", f.lox.vel_ff * 360),
+    FLOAT_COLUMN("ipa_vel_ff", f.ipa.vel_ff * 360),
+    FLOAT_COLUMN("lox_tracking_error", (f.lox.pos_cmd - f.lox.position) * 360),
+    FLOAT_COLUMN("ipa_tracking_error", (f.ipa.pos_cmd - f.ipa.position) * 360),
+    UINT_COLUMN("lox_feedback_age_us", f.lox.feedback_age_us),
+    UINT_COLUMN("ipa_feedback_age_us", f.ipa.feedback_age_us),
+};
+
+#define NUM_LOG_COLUMNS (sizeof(columns) / sizeof(columns[0]))
+
+uint32_t record[NUM_LOG_COLUMNS];
+
+void print_stats(const char *name, const LogWriter &writer) {
+  Log_Writer_Stats s = writer.getStats();
+  Router::info_no_newline(name);
+  Router::info_no_newline(": ");
+  Router::info_no_newline((unsigned long)(s.bytes_written / 1024));
+  Router::info_no_newline(" KiB written, ");
+  Router::info_no_newline(s.records);
+  Router::info_no_newline(" records, ");
+  Router::info_no_newline(s.dropped);
+  Router::info(" dropped.");
+  Router::info_no_newline("  buffer high water: ");
+  Router::info_no_newline(s.high_water);
+  Router::info_no_newline(" / ");
+  Router::info_no_newline(s.buffer_size);
+  Router::info_no_newline(" bytes, longest write (us): ");
+  Router::info(s.max_write_us);
+}
+
+void print_log_stats() {
+  print_stats("Curve log", log_writer);
+  print_stats("Console log", Router::comms_log_file);
+}
+
+void begin() {
+  Router::add({print_log_stats, "log_stats"});
+}
+
+// snapshots the controller, odrive and sensor state for one log row - cheap enough for the control tick.
+// odrive telemetry is taken as of the last updateTelemetry() call
+Curve_Log_Frame capture_frame(float time, int phase, float thrust, bool feed_forward, Sensor_Data sd) {
+  Curve_Log_Frame frame;
+  frame.time = time;
+  frame.phase = phase;
+  frame.thrust = thrust;
+  frame.feed_forward = feed_forward;
+
+  ODrive *odrives[2] = {&Driver::loxODrive, &Driver::ipaODrive};
+  ODrive_Telemetry *telem[2] = {&frame.lox, &frame.ipa};
+  for (int i = 0; i < 2; i++) {
+    telem[i]->pos_cmd = odrives[i]->getLastPosCmd();
+    telem[i]->vel_ff = odrives[i]->getLastVelFF();
+    telem[i]->position = odrives[i]->position;
+    telem[i]->velocity = odrives[i]->velocity;
+    telem[i]->voltage = odrives[i]->voltage;
+    telem[i]->current = odrives[i]->current;
+    telem[i]->feedback_age_us = odrives[i]->feedbackAge;
+  }
+
+  frame.sd = sd;
+  frame.cs = ClosedLoopControllers::getState();
+  frame.vc = vc_state;
+  frame.pt_latency_us = 0;
+  frame.kill_latency_us = 0;
+  frame.dac_bus_us = 0;
+  return frame;
+}
+
+uint32_t record_size() {
+  return sizeof(record);
+}
+
+unsigned num_columns() {
+  return NUM_LOG_COLUMNS;
+}
+
+const char *column_name(unsigned i) {
+  return columns[i].name;
+}
+
+char column_type(unsigned i) {
+  return columns[i].type;
+}
+
+// binary record of a frame, valid until the next pack()
+const uint32_t *pack(const Curve_Log_Frame &frame) {
+  for (unsigned i = 0; i < NUM_LOG_COLUMNS; i++) {
+    if (columns[i].type == CURVE_LOG_FLOAT) {
+      float value = columns[i].as_float(frame);
+      memcpy(&record[i], &value, sizeof(value));
+    } else {
+      record[i] = columns[i].as_uint(frame);
+    }
+  }
+  return record;
+}
+
+// packs one binary record into the log buffer, called from the control tick. nothing here waits on the card
+const uint32_t *log_frame(const Curve_Log_Frame &frame) {
+  pack(frame);
+  log_writer.append(record, sizeof(record));
+
+  if (!console_line_pending && frame.time - last_console_print >= CONSOLE_PRINT_INTERVAL_S) {
+    console_line = {frame.time, frame.thrust, frame.vc.measured_lox_mdot, frame.vc.measured_ipa_mdot};
+    console_line_pending = true;
+    last_console_print = frame.time;
   }
+  return record;
 }
 
-// creates a log file for the current curve and prints csv header
-void create_curve_log(const char *filename) {
-  odriveLogFile = SDCard::open(filename, FILE_WRITE);
-  odriveLogFile.println(LOG_HEADER);
+// writes buffered records to the card and prints the progress line, the background side of the control loop
+void service() {
+  log_writer.service();
+  if (millis() - last_sync_ms >= CURVE_LOG_SYNC_INTERVAL_MS) {
+    log_writer.sync();
+    last_sync_ms = millis();
+  }
+
+  if (console_line_pending) {
+    consolePrint.clear();
+    consolePrint << console_line.time << "  " << console_line.thrust << "  " << console_line.lox_mdot << "  " << console_line.ipa_mdot;
+    consolePrint.print();
+    console_line_pending = false;
+  }
 }
 
-// close and flush the log file
+// writes the file header and schema through out, returns the bytes written.
+// leading_column adds a float column in front of the frame's columns, nullptr for none
+uint32_t write_header(log_sink out, const char *leading_column) {
+  curve_log_header header;
+  header.num_fields = NUM_LOG_COLUMNS + (leading_column ? 1 : 0);
+  header.schema_size = leading_column ? 1 + strlen(leading_column) + 1 : 0;
+  for (unsigned i = 0; i < NUM_LOG_COLUMNS; i++) {
+    header.schema_size += 1 + strlen(columns[i].name) + 1;
+  }
+
+  out(&header, sizeof(header));
+  if (leading_column) {
+    const char type = CURVE_LOG_FLOAT;
+    out(&type, 1);
+    out(leading_column, strlen(leading_column) + 1);
+  }
+  for (unsigned i = 0; i < NUM_LOG_COLUMNS; i++) {
+    out(&columns[i].type, 1);
+    out(columns[i].name, strlen(columns[i].name) + 1);
+  }
+  return sizeof(header) + header.schema_size;
+}
+
+// creates a log file for the current curve, sized for expected_records, and writes the header and schema
+void create_curve_log(const char *filename, uint32_t expected_records) {
+  uint64_t file_size = 1024 + (uint64_t)expected_records * sizeof(record); // header and schema fit in 1 KiB
+  if (!log_writer.open(filename, file_size)) {
+    Router::info("WARNING: could not create the curve log.");
+  }
+
+  write_header([](const void *data, uint32_t len) { log_writer.append(data, len); }, nullptr);
+  log_writer.flush();
+  last_sync_ms = millis();
+
+  console_line_pending = false;
+  last_console_print = -CONSOLE_PRINT_INTERVAL_S;
+}
+
+// writes what is left in the buffer and closes the log file
 void close_curve_log() {
-  odriveLogFile.flush();
-  odriveLogFile.close();
+  service();
+  log_writer.close();
+  if (log_writer.getStats().dropped > 0) {
+    Router::info_no_newline("WARNING: dropped log records: ");
+    Router::info(log_writer.getStats().dropped);
+  }
 }
 
 } // namespace CurveLogger
@@ -1,13 +1,65 @@
 #ifndef CURVE_LOGGER_H
 #define CURVE_LOGGER_H
 
+#include <stdint.h>
+
 #include "valve_controller.h"
+#include "pi_controller.h"
+#include "LogWriter.h"
+
+#define CURVE_LOG_BUFFER_SIZE 131072   // bytes between the tick and the SD card, ~0.75 s of records at 1 kHz
+#define CONSOLE_PRINT_INTERVAL_S 0.05  // curve time between the progress lines printed while logging
+#define CURVE_LOG_SYNC_INTERVAL_MS 1000 // service() commits the log this often, the most a power loss or reset loses
+
+struct ODrive_Telemetry {
+  float pos_cmd;
+  float vel_ff; // velocity feed-forward sent with pos_cmd
+  float position;
+  float velocity;
+  float voltage;
+  float current;
+  uint32_t feedback_age_us; // age of the encoder estimate behind position and velocity
+};
+
+// everything in one row of the curve log, captured and packed in the control tick
+struct Curve_Log_Frame {
+  float time;
+  int phase;
+  float thrust;
+  bool feed_forward;
+  ODrive_Telemetry lox;
+  ODrive_Telemetry ipa;
+  Sensor_Data sd;
+  Controller_State cs;
+  VC_State vc;
+  uint32_t pt_latency_us; // from the PT sweep to the valve commands of the tick, 0 outside the control loop
+  uint32_t kill_latency_us; // Safety::kill_latency_us(), 0 until the curve is killed
+  uint32_t dac_bus_us;      // SPI1 time of the tick's zucrow DAC update, 0 if skipped (angles unchanged, no refresh due)
+};
+
+// receives the bytes of a log file
+typedef void (*log_sink)(const void *data, uint32_t len);
 
 namespace CurveLogger {
-void create_curve_log(const char *filename);
-void log_curve_csv(float time, int phase, float thrust, Sensor_Data sd);
+extern LogWriter log_writer;
+
+// registers the log_stats command
+void begin();
+
+void create_curve_log(const char *filename, uint32_t expected_records);
+Curve_Log_Frame capture_frame(float time, int phase, float thrust, bool feed_forward, Sensor_Data sd);
+const uint32_t *log_frame(const Curve_Log_Frame &frame); // control tick, returns the record it logged
+void service();                                          // background
 void close_curve_log();
 
+// the binary log format (CurveLog.h), for other writers of curve frames
+uint32_t record_size();
+unsigned num_columns();
+const char *column_name(unsigned i);
+char column_type(unsigned i); // CURVE_LOG_FLOAT or CURVE_LOG_UINT
+const uint32_t *pack(const Curve_Log_Frame &frame);
+uint32_t write_header(log_sink out, const char *leading_column);
+
 }; // namespace CurveLogger
 
 #endif
@@ -0,0 +1,115 @@
+#include "FlightRecorder.h"
+
+#include <Arduino.h>
+
+#include "ControlLoop.h"
+#include "CurveLogger.h"
+#include "LogWriter.h"
+#include "Router.h"
+
+#define DUMP_BUFFER_SIZE 16384 // bytes between the recording and the SD card while dumping
+
+namespace FlightRecorder {
+
+namespace {
+// every entry is the micros() it was recorded at followed by the packed record
+uint8_t *entries = nullptr;
+uint32_t entry_size;
+uint32_t capacity; // entries
+uint32_t count;    // entries recorded since start(), the newest capacity of them are kept
+uint32_t trigger_us;
+bool triggered;
+
+LogWriter dump_writer(DUMP_BUFFER_SIZE);
+
+void dump_entries(log_sink out) {
+  CurveLogger::write_header(out, "recorder_time");
+
+  uint32_t kept = min(count, capacity);
+  uint32_t reference_us = triggered ? trigger_us : 0;
+  for (uint32_t i = count - kept; i != count; i++) {
+    const uint8_t *entry = entries + (i % capacity) * entry_size;
+    uint32_t stamp_us;
+    memcpy(&stamp_us, entry, sizeof(stamp_us));
+    if (!triggered && i == count - kept) {
+      reference_us = stamp_us; // never started, times are from the first record
+    }
+    float t = (int32_t)(stamp_us - reference_us) / 1000000.0f;
+    out(&t, sizeof(t));
+    out(entry + sizeof(stamp_us), entry_size - sizeof(stamp_us));
+  }
+}
+
+void dump_recorder() {
+  if (count == 0) {
+    Router::info("Nothing recorded, the recorder starts when a curve is armed.");
+    return;
+  }
+  Router::info_no_newline("Enter dump filename (1-8 chars + '.LOG') or `serial`: ");
+  String filename = Router::read(50);
+
+  if (filename == "serial") {
+    Router::info_no_newline("RECORDER ");
+    Router::info(min(count, capacity));
+    dump_entries([](const void *data, uint32_t len) { Router::send((char *)data, len); });
+    return;
+  }
+
+  uint64_t size = 1024 + (uint64_t)min(count, capacity) * (entry_size + sizeof(float));
+  if (!dump_writer.open(filename.c_str(), size)) {
+    Router::info("Could not create the file.");
+    return;
+  }
+  dump_entries([](const void *data, uint32_t len) {
+    dump_writer.append(data, len);
+    dump_writer.service(); // keeps the buffer under a sector, every append fits
+  });
+  dump_writer.close();
+  Router::info_no_newline("Dumped ");
+  Router::info_no_newline(min(count, capacity));
+  Router::info(" records.");
+}
+} // namespace
+
+void begin() {
+  Router::add({dump_recorder, "dump_recorder"});
+}
+
+bool start(uint32_t curve_ticks) {
+  extmem_free(entries);
+  entry_size = sizeof(uint32_t) + CurveLogger::record_size();
+  capacity = RECORDER_PRE_TRIGGER_S * (1000000 / COMMAND_INTERVAL_US) + curve_ticks;
+  if ((uint64_t)capacity * entry_size > RECORDER_MAX_BYTES) {
+    capacity = RECORDER_MAX_BYTES / entry_size;
+    Router::info_no_newline("WARNING: curve is too long for the flight recorder, it keeps the last ");
+    Router::info_no_newline(capacity / (1000000 / COMMAND_INTERVAL_US));
+    Router::info(" s.");
+  }
+  entries = (uint8_t *)extmem_calloc(capacity, entry_size);
+  count = 0;
+  triggered = false;
+  if (entries == nullptr) {
+    capacity = 0;
+    Router::info("WARNING: no memory for the flight recorder, this curve is only in the SD log.");
+    return false;
+  }
+  return true;
+}
+
+void trigger() {
+  trigger_us = micros();
+  triggered = true;
+}
+
+void record(const uint32_t *packed) {
+  if (capacity == 0) {
+    return;
+  }
+  uint8_t *entry = entries + (count % capacity) * entry_size;
+  uint32_t now = micros();
+  memcpy(entry, &now, sizeof(now));
+  memcpy(entry + sizeof(now), packed, entry_size - sizeof(now));
+  count++;
+}
+
+} // namespace FlightRecorder
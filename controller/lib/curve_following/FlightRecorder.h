@@ -0,0 +1,39 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+/*
+ * FlightRecorder.h
+ *
+ *  Description: Keeps every tick's curve log record (sensors, controller state, odrive feedback) in
+ *  EXTMEM for the whole curve, independent of the decimated SD log and without touching the card while
+ *  the curve runs. start() sizes the buffer for the loaded curve plus RECORDER_PRE_TRIGGER_S of the wait
+ *  for Zucrow's go signal before it; the buffer is circular, so the wait keeps overwriting itself until
+ *  the curve starts and only its last RECORDER_PRE_TRIGGER_S survive.
+ *
+ *  `dump_recorder` writes the recording as a binary curve log (decode with log_decoder) to the SD card,
+ *  or streams the same bytes over serial for curve_writer/pull_recorder.py. The dump has an extra first
+ *  column, recorder_time, in seconds from the curve start - negative for the pre-trigger window.
+ */
+
+#include <stdint.h>
+
+#define RECORDER_PRE_TRIGGER_S 5             // wait before the go signal that is kept
+#define RECORDER_MAX_BYTES (6 * 1024 * 1024) // of the 8 MB PSRAM, leaves room for the curves and log buffers
+
+namespace FlightRecorder {
+
+// registers the dump_recorder command
+void begin();
+
+// allocates a recording for the pre-trigger window plus curve_ticks ticks, dropping the previous one
+bool start(uint32_t curve_ticks);
+
+// the curve starts now, earlier records are the pre-trigger window
+void trigger();
+
+// adds a packed curve log record (CurveLogger::pack), overwriting the oldest once full
+void record(const uint32_t *packed);
+
+} // namespace FlightRecorder
+
+#endif
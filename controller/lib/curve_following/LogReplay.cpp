@@ -0,0 +1,223 @@
+#include "LogReplay.h"
+
+#include "valve_controller.h"
+#include "pi_controller.h"
+#include "CString.h"
+#include "SDCard.h"
+#include "Router.h"
+
+#define REPLAY_LINE_LEN 1024 // longest log line, the header is ~900 chars
+#define REPLAY_MAX_COLUMNS 64
+
+#define REPLAY_HEADER ("time,thrust_cmd,lox_angle,ipa_angle,logged_lox_angle,logged_ipa_angle,"                      \
+                       "chamber_pressure_controller_p_component,chamber_pressure_controller_i_component,"          \
+                       "lox_angle_controller_p_component,lox_angle_controller_i_component,"                        \
+                       "ipa_angle_controller_p_component,ipa_angle_controller_i_component,"                        \
+                       "lox_mdot,ipa_mdot,ol_lox_mdot,ol_ipa_mdot,ol_lox_angle,ol_ipa_angle,"                      \
+                       "lox_valve_downstream_pressure_calc,ipa_valve_downstream_pressure_calc")
+
+namespace LogReplay {
+
+namespace {
+// log columns the replay reads, looked up by name so older logs with extra columns still work
+enum Column {
+  COL_TIME,
+  COL_THRUST,
+  COL_LOX_POS_CMD,
+  COL_IPA_POS_CMD,
+  COL_LOX_POS,
+  COL_IPA_POS,
+  COL_CHAMBER,
+  COL_LOX_UPSTREAM,
+  COL_LOX_DOWNSTREAM,
+  COL_LOX_VENTURI_DIFF,
+  COL_LOX_VENTURI_TEMP,
+  COL_LOX_VALVE_TEMP,
+  COL_IPA_UPSTREAM,
+  COL_IPA_DOWNSTREAM,
+  COL_IPA_VENTURI_DIFF,
+  COL_OL_LOX_ANGLE,
+  NUM_COLUMNS
+};
+
+const char *column_names[NUM_COLUMNS] = {
+    "time", "thrust_cmd", "lox_pos_cmd", "ipa_pos_cmd", "lox_pos", "ipa_pos", "chamber_pressure",
+    "lox_valve_upstream_pressure", "lox_valve_downstream_pressure", "lox_venturi_differential_pressure",
+    "lox_venturi_temperature", "lox_valve_temperature",
+    "ipa_valve_upstream_pressure", "ipa_valve_downstream_pressure", "ipa_venturi_differential_pressure",
+    "ol_lox_angle",
+};
+
+char line[REPLAY_LINE_LEN];
+CString<400> out_row;
+
+// reads one line into `line` without the line ending, returns false at the end of the file
+bool read_line(File &f) {
+  int len = 0;
+  int c;
+  while ((c = f.read()) >= 0 && c != '\n') {
+    if (c != '\r' && len < REPLAY_LINE_LEN - 1) {
+      line[len++] = c;
+    }
+  }
+  line[len] = '\0';
+  return c >= 0 || len > 0;
+}
+
+// fills column_index with each column's position in the header, returns false if one is missing
+bool parse_header(int column_index[NUM_COLUMNS]) {
+  for (int i = 0; i < NUM_COLUMNS; i++) {
+    column_index[i] = -1;
+  }
+  char *save;
+  int position = 0;
+  for (char *name = strtok_r(line, ",", &save); name != nullptr; name = strtok_r(nullptr, ",", &save), position++) {
+    for (int i = 0; i < NUM_COLUMNS; i++) {
+      if (cstring::equals(name, column_names[i])) {
+        column_index[i] = position;
+      }
+    }
+  }
+
+  for (int i = 0; i < NUM_COLUMNS; i++) {
+    if (column_index[i] < 0) {
+      Router::info_no_newline("REPLAY FAILURE: log has no column ");
+      Router::info(column_names[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// splits `line` into values, returns the number found
+int parse_row(float values[REPLAY_MAX_COLUMNS]) {
+  int count = 0;
+  char *p = line;
+  while (count < REPLAY_MAX_COLUMNS) {
+    values[count++] = strtof(p, &p);
+    p = strchr(p, ',');
+    if (p == nullptr) {
+      break;
+    }
+    p++;
+  }
+  return count;
+}
+
+void replay_log() {
+  Router::info_no_newline("Enter log filename: ");
+  String in_path = Router::read(50);
+  Router::info_no_newline("Enter output filename: ");
+  String out_path = Router::read(50);
+
+  int rows = replay(in_path.c_str(), out_path.c_str());
+  if (rows >= 0) {
+    Router::info_no_newline("Replayed ");
+    Router::info_no_newline(rows);
+    Router::info(" rows.");
+  }
+}
+} // namespace
+
+int replay(const char *in_path, const char *out_path) {
+  File in = SDCard::open(in_path, FILE_READ);
+  if (!in) {
+    Router::info("REPLAY FAILURE: log file not found.");
+    return -1;
+  }
+
+  int col[NUM_COLUMNS];
+  if (!read_line(in) || !parse_header(col)) {
+    in.close();
+    return -1;
+  }
+  int last_col = 0;
+  for (int i = 0; i < NUM_COLUMNS; i++) {
+    last_col = max(last_col, col[i]);
+  }
+
+  SD.remove(out_path);
+  File out = SDCard::open(out_path, FILE_WRITE);
+  if (!out) {
+    Router::info("REPLAY FAILURE: could not create output file.");
+    in.close();
+    return -1;
+  }
+  out.println(REPLAY_HEADER);
+
+  ClosedLoopControllers::reset();
+  float values[REPLAY_MAX_COLUMNS];
+  float last_lox_cmd = -1; // command in effect when the row's sensors were read
+  float last_ipa_cmd = -1;
+  int rows = 0;
+  float max_lox_diff = 0;
+  float max_ipa_diff = 0;
+
+  while (read_line(in)) {
+    int count = parse_row(values);
+    if (line[0] == '\0' || count <= last_col) {
+      continue; // blank or truncated row, e.g. the last row of a log cut off by a power loss
+    }
+
+    Sensor_Data sd = {};
+    sd.chamber_pressure = values[col[COL_CHAMBER]];
+    sd.ox.valve_upstream_pressure = values[col[COL_LOX_UPSTREAM]];
+    sd.ox.valve_downstream_pressure = values[col[COL_LOX_DOWNSTREAM]];
+    sd.ox.venturi_differential_pressure = values[col[COL_LOX_VENTURI_DIFF]];
+    sd.ox.venturi_temperature = values[col[COL_LOX_VENTURI_TEMP]];
+    sd.ox.valve_temperature = values[col[COL_LOX_VALVE_TEMP]];
+    sd.ipa.valve_upstream_pressure = values[col[COL_IPA_UPSTREAM]];
+    sd.ipa.valve_downstream_pressure = values[col[COL_IPA_DOWNSTREAM]];
+    sd.ipa.venturi_differential_pressure = values[col[COL_IPA_VENTURI_DIFF]];
+
+    float time = values[col[COL_TIME]];
+    float thrust = values[col[COL_THRUST]];
+    float logged_lox_cmd = values[col[COL_LOX_POS_CMD]];
+    float logged_ipa_cmd = values[col[COL_IPA_POS_CMD]];
+    if (last_lox_cmd < 0) {
+      last_lox_cmd = logged_lox_cmd;
+      last_ipa_cmd = logged_ipa_cmd;
+    }
+
+    float angle_ox = logged_lox_cmd * 360;
+    float angle_ipa = logged_ipa_cmd * 360;
+    if (thrust < 0 || values[col[COL_OL_LOX_ANGLE]] == 0) {
+      log_only(sd); // angle curve, or holding the start position before the first thrust point
+    } else {
+      float lox_acc_factor = tracking_acc_factor(last_lox_cmd, values[col[COL_LOX_POS]]);
+      float ipa_acc_factor = tracking_acc_factor(last_ipa_cmd, values[col[COL_IPA_POS]]);
+      closed_loop_thrust_control(thrust, sd, lox_acc_factor, ipa_acc_factor, (long long)(time * 1000 + 0.5), &angle_ox, &angle_ipa);
+      max_lox_diff = max(max_lox_diff, fabsf(angle_ox - logged_lox_cmd * 360));
+      max_ipa_diff = max(max_ipa_diff, fabsf(angle_ipa - logged_ipa_cmd * 360));
+    }
+    last_lox_cmd = logged_lox_cmd;
+    last_ipa_cmd = logged_ipa_cmd;
+
+    Controller_State cs = ClosedLoopControllers::getState();
+    out_row.clear();
+    out_row << time << "," << thrust << "," << angle_ox << "," << angle_ipa << ","
+            << logged_lox_cmd * 360 << "," << logged_ipa_cmd * 360 << ","
+            << cs.chamber_pressure_controller_p_component << "," << cs.chamber_pressure_controller_i_component << ","
+            << cs.lox_angle_controller_p_component << "," << cs.lox_angle_controller_i_component << ","
+            << cs.ipa_angle_controller_p_component << "," << cs.ipa_angle_controller_i_component << ","
+            << vc_state.measured_lox_mdot << "," << vc_state.measured_ipa_mdot << ","
+            << vc_state.ol_lox_mdot << "," << vc_state.ol_ipa_mdot << "," << vc_state.ol_lox_angle << "," << vc_state.ol_ipa_angle << ","
+            << vc_state.ox_valve_downstream_calc << "," << vc_state.ipa_valve_downstream_calc;
+    out.println(out_row.str);
+    rows++;
+  }
+
+  in.close();
+  out.close();
+
+  out_row.clear();
+  out_row << "Largest difference from logged angle (deg) lox: " << max_lox_diff << ", ipa: " << max_ipa_diff;
+  Router::info(out_row.str);
+  return rows;
+}
+
+void begin() {
+  Router::add({replay_log, "replay_log"});
+}
+
+} // namespace LogReplay
@@ -0,0 +1,24 @@
+#ifndef LOG_REPLAY_H
+#define LOG_REPLAY_H
+
+/*
+ * LogReplay.h
+ *
+ *  Description: Re-runs the thrust controller over a curve log (the CSV written by CurveLogger).
+ *  Each logged row's sensor data and thrust command go through closed_loop_thrust_control with the
+ *  log's time column as the PI controllers' time base, so a run is reproduced exactly and as fast
+ *  as the processor allows. Nothing is sent to the odrives. Use it to evaluate controller changes
+ *  against real hot fire data; on the native build a 20 s log replays in milliseconds.
+ */
+
+namespace LogReplay {
+
+// registers the replay_log command
+void begin();
+
+// replays in_path into out_path, returns the number of rows replayed or -1 if a file can't be used
+int replay(const char *in_path, const char *out_path);
+
+} // namespace LogReplay
+
+#endif
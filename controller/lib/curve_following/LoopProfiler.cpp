@@ -0,0 +1,89 @@
+#include "LoopProfiler.h"
+
+#include "Router.h"
+
+#define CYCLES_PER_BIN (F_CPU_ACTUAL / 1000000 * PROFILE_BIN_US)
+
+namespace LoopProfiler {
+
+volatile Stage current_stage = NUM_STAGES;
+
+namespace {
+struct Stage_Profile {
+  uint32_t count;
+  uint32_t min_cycles;
+  uint32_t max_cycles;
+  uint64_t total_cycles;
+  uint32_t bins[PROFILE_NUM_BINS];
+};
+
+Stage_Profile profiles[NUM_STAGES];
+
+const char *stage_names[NUM_STAGES] = {
+    "sensors", "control", "lox_setpos", "ipa_setpos", "zucrow", "tc_poll", "log", "kill_check", "tick",
+};
+
+float cycles_to_us(uint64_t cycles) {
+  return cycles / (F_CPU_ACTUAL / 1000000.0);
+}
+
+// upper edge of the bin holding the 99th percentile sample, never more than the max
+float p99_us(const Stage_Profile &p) {
+  uint32_t target = p.count - p.count / 100;
+  uint32_t seen = 0;
+  int bin = 0;
+  while (bin < PROFILE_NUM_BINS - 1 && seen + p.bins[bin] < target) {
+    seen += p.bins[bin];
+    bin++;
+  }
+  return min((float)((bin + 1) * PROFILE_BIN_US), cycles_to_us(p.max_cycles));
+}
+} // namespace
+
+void reset() {
+  for (int i = 0; i < NUM_STAGES; i++) {
+    profiles[i] = {};
+    profiles[i].min_cycles = UINT32_MAX;
+  }
+}
+
+void record(Stage stage, uint32_t start_cycles) {
+  uint32_t cycles = ARM_DWT_CYCCNT - start_cycles;
+  Stage_Profile &p = profiles[stage];
+  p.count++;
+  p.total_cycles += cycles;
+  p.min_cycles = min(p.min_cycles, cycles);
+  p.max_cycles = max(p.max_cycles, cycles);
+  p.bins[min(cycles / CYCLES_PER_BIN, (uint32_t)PROFILE_NUM_BINS - 1)]++;
+  current_stage = stage == STAGE_TICK ? NUM_STAGES : STAGE_TICK;
+}
+
+const char *stage_name(int stage) {
+  return stage >= 0 && stage < NUM_STAGES ? stage_names[stage] : "outside the tick";
+}
+
+void print() {
+  char line[96];
+  Router::info("Loop profile (us)     count      min     mean      p99      max");
+  for (int i = 0; i < NUM_STAGES; i++) {
+    noInterrupts();
+    Stage_Profile p = profiles[i];
+    interrupts();
+
+    if (p.count == 0) {
+      snprintf(line, sizeof(line), "%15s %10d        -        -        -        -", stage_names[i], 0);
+    } else {
+      snprintf(line, sizeof(line), "%15s %10lu %8.2f %8.2f %8.2f %8.2f", stage_names[i], (unsigned long)p.count,
+               cycles_to_us(p.min_cycles), cycles_to_us(p.total_cycles) / p.count, p99_us(p),
+               cycles_to_us(p.max_cycles));
+    }
+    Router::info(line);
+  }
+}
+
+void begin() {
+  reset();
+  Router::add({print, "loop_profile"});
+}
+
+} // namespace LoopProfiler
@@ -0,0 +1,58 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+/*
+ * LoopProfiler.h
+ *
+ *  Description: Times each stage of the curve following loop with the DWT cycle counter and keeps a
+ *  histogram per stage, so min/mean/p99/max can be printed with `loop_profile` after a run.
+ *  Cheap enough to leave on during hot fires: a record is a counter read, a divide and a few adds.
+ */
+
+#include <Arduino.h>
+
+#define PROFILE_BIN_US 2    // histogram resolution
+#define PROFILE_NUM_BINS 512 // covers 0 - 1024 us, slower samples land in the last bin
+
+namespace LoopProfiler {
+
+enum Stage {
+  STAGE_SENSORS,      // get_sensor_data
+  STAGE_CONTROL,      // closed_loop_thrust_control
+  STAGE_LOX_SETPOS,   // loxODrive.setPos
+  STAGE_IPA_SETPOS,   // ipaODrive.setPos
+  STAGE_ZUCROW,       // send_valve_angles_to_zucrow
+  STAGE_TC_POLL,      // Acquisition::poll_tcs
+  STAGE_LOG,          // capture_frame + log_frame, packing the record into the log buffer
+  STAGE_KILL_CHECK,   // check_for_kill
+  STAGE_TICK,         // the whole control tick
+  NUM_STAGES
+};
+
+// registers the loop_profile command
+void begin();
+
+// clears all stages, called at the start of every curve
+void reset();
+
+// stage the control tick is executing, STAGE_TICK between stages and NUM_STAGES outside the tick.
+// the watchdog records it when the loop hangs
+extern volatile Stage current_stage;
+
+// marks the stage as executing, returns the cycle count to pass to record() once it is done
+inline uint32_t start(Stage stage) {
+  current_stage = stage;
+  return ARM_DWT_CYCCNT;
+}
+
+// adds the time since start_cycles to the stage's histogram
+void record(Stage stage, uint32_t start_cycles);
+
+// name of a stage, "outside the tick" for NUM_STAGES
+const char *stage_name(int stage);
+
+void print();
+
+} // namespace LoopProfiler
+
+#endif
@@ -1,10 +1,44 @@
 #include "Safety.h"
 
+#include <Arduino.h>
+
+#include "ControlLoop.h"
+#include "teensy_pins.h"
 #include "WindowComparator.h"
 #include "ZucrowInterface.h"
 #include "Driver.h"
 #include "Router.h"
 
+static volatile bool zucrow_abort_armed = false;
+static volatile bool zucrow_abort_latched = false;
+static volatile bool kill_timed = false;
+static volatile uint32_t kill_trigger_us;
+static volatile uint32_t kill_frame_us;
+static volatile bool kill_from_edge;
+
+// disables the odrives and sends a fault to zucrow, timing the first kill since arm
+static void kill_from(uint32_t trigger_us, bool edge) {
+  Driver::loxODrive.setState(AXIS_STATE_IDLE);
+  if (!kill_timed) {
+    kill_frame_us = micros();
+    kill_trigger_us = trigger_us;
+    kill_from_edge = edge;
+    kill_timed = true;
+  }
+  Driver::ipaODrive.setState(AXIS_STATE_IDLE);
+  ZucrowInterface::send_fault_to_zucrow();
+}
+
+// falling edge of the zucrow panic line
+static void on_zucrow_panic() {
+  uint32_t edge_us = micros();
+  if (!zucrow_abort_armed || zucrow_abort_latched) {
+    return;
+  }
+  zucrow_abort_latched = true;
+  kill_from(edge_us, true);
+}
+
 // prints which safety features are active
 void Safety::begin() {
 #ifndef ENABLE_ZUCROW_SAFETY
@@ -16,14 +50,76 @@ void Safety::begin() {
 #ifndef ENABLE_WC_SAFETY_CHECKS
   Router::info("WARNING! Running without wc safety.");
 #endif
+
+#ifdef ENABLE_ZUCROW_SAFETY
+  attachInterrupt(digitalPinToInterrupt(ZUCROW_PANIC_PIN), on_zucrow_panic, FALLING); // ZUCROW_PANIC is low
+  NVIC_SET_PRIORITY(IRQ_GPIO6789, ZUCROW_ABORT_PRIORITY); // every GPIO interrupt shares this vector
+#endif
 }
 
-// prints debug information after a kill
-void Safety::kill_response(int kill_reason) {
-  Driver::loxODrive.setState(AXIS_STATE_IDLE);
-  Driver::ipaODrive.setState(AXIS_STATE_IDLE);
+void Safety::arm_zucrow_abort() {
+  kill_timed = false;
+  zucrow_abort_latched = false;
+  zucrow_abort_armed = true;
+}
+
+void Safety::disarm_zucrow_abort() {
+  zucrow_abort_armed = false;
+}
+
+uint32_t Safety::kill_latency_us() {
+  noInterrupts();
+  uint32_t latency = kill_timed ? kill_frame_us - kill_trigger_us : 0;
+  interrupts();
+  return latency;
+}
+
+static volatile bool serial_kill_requested = false;
+
+void Safety::request_serial_kill() {
+  serial_kill_requested = true;
+}
+
+void Safety::clear_serial_kill() {
+  serial_kill_requested = false;
+}
+
+// disables the odrives and sends a fault to zucrow
+void Safety::kill() {
+  kill_from(micros(), false);
+}
+
+// the watchdog may have interrupted a tick in the middle of a FlexCAN write, so setState() is off limits
+void Safety::kill_from_interrupt() {
+  Driver::loxODrive.idleFromInterrupt();
+  Driver::ipaODrive.idleFromInterrupt();
   ZucrowInterface::send_fault_to_zucrow();
+}
+
+void Safety::kill_response(int kill_reason) {
+  kill();
+  print_kill_reason(kill_reason);
+}
+
+static void print_stale(const char *msg, uint32_t age_us) {
+  Router::info_no_newline(msg);
+  if (age_us == UINT32_MAX) {
+    Router::info("never arrived");
+    return;
+  }
+  Router::info_no_newline(age_us / 1000);
+  Router::info(" ms ago");
+}
+
+// prints debug information after a kill
+void Safety::print_kill_reason(int kill_reason) {
   Router::info("Fault detected! Curve following terminated, odrives disabled, fault signal sent to Zucrow.");
+  if (kill_timed) {
+    Router::info_no_newline("Kill latency: ");
+    Router::info_no_newline(kill_latency_us());
+    Router::info(kill_from_edge ? " us from the zucrow panic edge to the first odrive idle frame"
+                                : " us from detection to the first odrive idle frame");
+  }
   Router::info_no_newline("Fault cause: ");
 
   if (kill_reason == KILLED_BY_ZUCROW) {
@@ -44,6 +140,18 @@ void Safety::kill_response(int kill_reason) {
   if (kill_reason == KILLED_BY_ODRIVE_FAULT_IPA) {
     Router::info("ipa odrive fault");
   }
+  if (kill_reason == KILLED_BY_STALE_ENCODER_LOX) {
+    print_stale("lox odrive encoder estimates stopped, last one ", Driver::loxODrive.encoderAge());
+  }
+  if (kill_reason == KILLED_BY_STALE_ENCODER_IPA) {
+    print_stale("ipa odrive encoder estimates stopped, last one ", Driver::ipaODrive.encoderAge());
+  }
+  if (kill_reason == KILLED_BY_STALE_HEARTBEAT_LOX) {
+    print_stale("lox odrive heartbeats stopped, last one ", Driver::loxODrive.heartbeatAge());
+  }
+  if (kill_reason == KILLED_BY_STALE_HEARTBEAT_IPA) {
+    print_stale("ipa odrive heartbeats stopped, last one ", Driver::ipaODrive.heartbeatAge());
+  }
   if (kill_reason == KILLED_BY_WC) {
     Router::info_no_newline("Window comparator ");
     Router::info_no_newline(WindowComparators::WC_ERROR.causeID);
@@ -52,6 +160,10 @@ void Safety::kill_response(int kill_reason) {
       Router::info_no_newline(WindowComparators::WC_ERROR.causeValue);
       Router::info_no_newline(" > ");
       Router::info(WindowComparators::WC_ERROR.compValue);
+    } else if (WindowComparators::WC_ERROR.causeReason == WC_CAUSE_INVALID) {
+      Router::info_no_newline(" had no valid reading for ");
+      Router::info_no_newline((int)WindowComparators::WC_ERROR.causeValue);
+      Router::info(" checks in a row");
     } else {
       Router::info_no_newline(" underflow ");
       Router::info_no_newline(WindowComparators::WC_ERROR.causeValue);
@@ -64,31 +176,46 @@ void Safety::kill_response(int kill_reason) {
 // checks various kill conditions, returns the first one found, or DONT_KILL
 int Safety::check_for_kill(float time_seconds) {
 #ifdef ENABLE_ZUCROW_SAFETY
-  if (ZucrowInterface::check_fault_from_zucrow()) {
+  // the edge interrupt normally got there first, polling the line catches a panic already held at start
+  if (zucrow_abort_latched || ZucrowInterface::check_fault_from_zucrow()) {
     return KILLED_BY_ZUCROW;
   }
 #endif
 
 #ifdef CHECK_SERIAL_KILL
-  if (COMMS_SERIAL.available() && COMMS_SERIAL.read() == 'k') {
+  if (serial_kill_requested) {
     return KILLED_BY_SERIAL;
   }
 #endif
 
 #ifdef ENABLE_ODRIVE_SAFETY_CHECKS
+  // a silent odrive keeps its last position and state, check that they are current before trusting them
+  if (Driver::loxODrive.encoderStale()) {
+    return KILLED_BY_STALE_ENCODER_LOX;
+  }
+  if (Driver::ipaODrive.encoderStale()) {
+    return KILLED_BY_STALE_ENCODER_IPA;
+  }
+  if (Driver::loxODrive.heartbeatStale()) {
+    return KILLED_BY_STALE_HEARTBEAT_LOX;
+  }
+  if (Driver::ipaODrive.heartbeatStale()) {
+    return KILLED_BY_STALE_HEARTBEAT_IPA;
+  }
+
   if (time_seconds > ANGLE_OOR_START) {
-    if (abs((0.25 - Driver::loxODrive.last_enc_msg.Pos_Estimate) - Driver::loxODrive.getLastPosCmd()) > ANGLE_OOR_THRESH) {
+    if (abs((0.25 - Driver::loxODrive.last_enc_msg.read().Pos_Estimate) - Driver::loxODrive.getLastPosCmd()) > ANGLE_OOR_THRESH) {
       return KILLED_BY_ANGLE_OOR_LOX;
     }
-    if (abs((0.25 - Driver::ipaODrive.last_enc_msg.Pos_Estimate) - Driver::ipaODrive.getLastPosCmd()) > ANGLE_OOR_THRESH) {
+    if (abs((0.25 - Driver::ipaODrive.last_enc_msg.read().Pos_Estimate) - Driver::ipaODrive.getLastPosCmd()) > ANGLE_OOR_THRESH) {
       return KILLED_BY_ANGLE_OOR_IPA;
     }
   }
 
-  if (Driver::loxODrive.odrive_status.last_heartbeat.Axis_State != AXIS_STATE_CLOSED_LOOP_CONTROL) {
+  if (Driver::loxODrive.last_heartbeat.read().Axis_State != AXIS_STATE_CLOSED_LOOP_CONTROL) {
     return KILLED_BY_ODRIVE_FAULT_LOX;
   }
-  if (Driver::ipaODrive.odrive_status.last_heartbeat.Axis_State != AXIS_STATE_CLOSED_LOOP_CONTROL) {
+  if (Driver::ipaODrive.last_heartbeat.read().Axis_State != AXIS_STATE_CLOSED_LOOP_CONTROL) {
     return KILLED_BY_ODRIVE_FAULT_IPA;
   }
 #endif
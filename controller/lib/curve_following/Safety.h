@@ -1,6 +1,8 @@
 #ifndef SAFETY_H
 #define SAFETY_H
 
+#include <stdint.h>
+
 #define CHECK_SERIAL_KILL           // should check for 'k' on serial monitor to kill
 #define ENABLE_ZUCROW_SAFETY        // checks for zucrow ok before starting
 #define ENABLE_ODRIVE_SAFETY_CHECKS // check if odrive disconnects or falls behind
@@ -16,11 +18,35 @@
 #define KILLED_BY_ODRIVE_FAULT_LOX 5    // odrive exits closed loop control
 #define KILLED_BY_ODRIVE_FAULT_IPA 6    // odrive exits closed loop control
 #define KILLED_BY_WC 7                  // window comparator checks
+#define KILLED_BY_STALE_ENCODER_LOX 8   // no encoder estimate for ODRIVE_STALE_INTERVALS intervals
+#define KILLED_BY_STALE_ENCODER_IPA 9   // no encoder estimate for ODRIVE_STALE_INTERVALS intervals
+#define KILLED_BY_STALE_HEARTBEAT_LOX 10 // no heartbeat for ODRIVE_STALE_INTERVALS intervals
+#define KILLED_BY_STALE_HEARTBEAT_IPA 11 // no heartbeat for ODRIVE_STALE_INTERVALS intervals
+
+// the Zucrow panic line's falling edge kills from an interrupt at the control tick's priority: it never
+// cuts into a tick's CAN writes, and runs as soon as the current tick (if any) returns
+#define ZUCROW_ABORT_PRIORITY CONTROL_LOOP_PRIORITY
 
 namespace Safety {
-void begin();
-void kill_response(int kill_reason);
+void begin();                            // prints safety info, attaches the zucrow panic interrupt
+void kill();                             // disables odrives and signals zucrow, safe to call from the control tick
+void kill_from_interrupt();              // kill() through the reserved CAN mailboxes, for the watchdog interrupt
+void print_kill_reason(int kill_reason); // prints debug information, call from the background
+void kill_response(int kill_reason);     // kill() followed by print_kill_reason()
 int check_for_kill(float time_seconds);
+
+// the control tick can't read the console, the background forwards a 'k' with this
+void request_serial_kill();
+void clear_serial_kill();
+
+// between these the zucrow panic edge kills right away and latches KILLED_BY_ZUCROW for check_for_kill.
+// arm also forgets the last kill's latency
+void arm_zucrow_abort();
+void disarm_zucrow_abort();
+
+// from the kill's cause (panic edge, or the check that found it) to the first ODrive idle frame queued
+// on CAN, of the first kill since arm_zucrow_abort(). 0 if there was none
+uint32_t kill_latency_us();
 } // namespace Safety
 
 #endif
\ No newline at end of file
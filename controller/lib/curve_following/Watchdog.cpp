@@ -0,0 +1,126 @@
+#include "Watchdog.h"
+
+#include <Arduino.h>
+
+#include "ControlLoop.h"
+#include "LoopProfiler.h"
+#include "Router.h"
+#include "Safety.h"
+#include "Scheduler.h"
+
+#define WATCHDOG_RECORD_MAGIC 0x474F4457 // "WDOG" in little endian memory
+
+static_assert(WATCHDOG_KILL_MS % 500 == 0 && WATCHDOG_PRETIMEOUT_MS % 500 == 0 && WATCHDOG_IDLE_TIMEOUT_MS % 500 == 0,
+              "WDOG1 counts in half seconds");
+static_assert(WATCHDOG_IDLE_TIMEOUT_MS <= 128000, "WDOG1 times out after at most 128 s");
+
+namespace Watchdog {
+
+namespace {
+// written by the pre-timeout interrupt, read and cleared by the next boot
+struct Reason_Record {
+  uint32_t magic;
+  uint32_t uptime_ms; // millis() when the watchdog fired
+  uint32_t ticks;     // control ticks of the running (or last) curve
+  uint8_t stage;      // LoopProfiler::Stage executing, NUM_STAGES outside the tick
+  uint8_t armed;      // inside arm(), otherwise between commands after a curve
+};
+
+DMAMEM Reason_Record reset_record; // RAM2 survives the reset and is not cleared at startup
+Reason_Record last = {};
+IntervalTimer idle_feeder; // feeds while disarmed, so only arm() is supervised
+bool enabled = false;
+volatile bool armed = false;
+
+// WT counts half seconds, 0 is 0.5 s. SRS and WDA are active low, writing 0 would reset the Teensy
+void set_timeout(uint32_t timeout_ms) {
+  WDOG1_WCR = WDOG_WCR_WT(timeout_ms / 500 - 1) | WDOG_WCR_SRS | WDOG_WCR_WDA | (WDOG1_WCR & WDOG_WCR_WDE);
+}
+
+// pre-timeout interrupt, the reset follows WATCHDOG_PRETIMEOUT_MS later
+void on_pretimeout() {
+  WDOG1_WICR = WDOG1_WICR | WDOG_WICR_WTIS;
+  if (armed) {
+    Safety::kill_from_interrupt(); // disarmed the valves are parked, a reset is enough
+  }
+
+  reset_record.magic = WATCHDOG_RECORD_MAGIC;
+  reset_record.uptime_ms = millis();
+  reset_record.ticks = ControlLoop::get_stats().ticks;
+  reset_record.stage = LoopProfiler::current_stage;
+  reset_record.armed = armed;
+  arm_dcache_flush(&reset_record, sizeof(reset_record)); // RAM2 is cached, the reset would drop the lines
+}
+
+void print_last() {
+  if (last.magic != WATCHDOG_RECORD_MAGIC) {
+    Router::info("No watchdog reset since the last one was reported.");
+    return;
+  }
+  Router::info_no_newline("WATCHDOG RESET: the firmware hung ");
+  Router::info_no_newline(last.armed ? "during arm, " : "between commands, ");
+  Router::info_no_newline(last.uptime_ms / 1000);
+  Router::info(last.armed ? " s after boot. ODrives were idled and Zucrow signalled before the reset." : " s after boot.");
+  Router::info_no_newline("Executing: ");
+  Router::info_no_newline(LoopProfiler::stage_name(last.stage));
+  Router::info_no_newline(", control ticks completed: ");
+  Router::info(last.ticks);
+}
+} // namespace
+
+void begin() {
+  if (reset_record.magic == WATCHDOG_RECORD_MAGIC) {
+    last = reset_record;
+    print_last();
+    reset_record = {}; // report it once, `watchdog` still shows it until reboot
+    arm_dcache_flush(&reset_record, sizeof(reset_record));
+  }
+  Router::add({print_last, "watchdog"});
+}
+
+void arm() {
+  if (!enabled) {
+    WDOG1_WMCR = 0; // no power down counter
+    attachInterruptVector(IRQ_WDOG1, on_pretimeout);
+    NVIC_SET_PRIORITY(IRQ_WDOG1, WATCHDOG_PRIORITY);
+    NVIC_ENABLE_IRQ(IRQ_WDOG1);
+    WDOG1_WICR = WDOG_WICR_WIE | WDOG_WICR_WICT(WATCHDOG_PRETIMEOUT_MS / 500); // write once
+    set_timeout(WATCHDOG_KILL_MS + WATCHDOG_PRETIMEOUT_MS);
+    WDOG1_WCR = WDOG1_WCR | WDOG_WCR_WDE; // write once, there is no turning it off again
+    Scheduler::every("watchdog", WATCHDOG_FEED_INTERVAL_US, feed);
+    enabled = true;
+  } else {
+    idle_feeder.end();
+    set_timeout(WATCHDOG_KILL_MS + WATCHDOG_PRETIMEOUT_MS);
+  }
+  armed = true;
+  feed(); // a new timeout takes effect at the next service
+}
+
+void disarm() {
+  if (!enabled) {
+    return;
+  }
+  set_timeout(WATCHDOG_IDLE_TIMEOUT_MS);
+  armed = false;
+  feed();
+  idle_feeder.priority(WATCHDOG_IDLE_FEED_PRIORITY);
+  idle_feeder.begin(feed, WATCHDOG_FEED_INTERVAL_US);
+}
+
+void feed() {
+  // the service sequence must not be split by a feed from the tick. restores the caller's PRIMASK
+  // instead of enabling interrupts, feed() also runs in the tick and in masked sections
+  uint32_t primask = 0;
+#ifndef NATIVE_BUILD
+  __asm__ volatile("mrs %0, primask" : "=r"(primask));
+#endif // the native interrupt mask nests, disable/enable restores it
+  __disable_irq();
+  WDOG1_WSR = 0x5555;
+  WDOG1_WSR = 0xAAAA;
+  if (!primask) {
+    __enable_irq();
+  }
+}
+
+} // namespace Watchdog
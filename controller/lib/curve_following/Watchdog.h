@@ -0,0 +1,47 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+/*
+ * Watchdog.h
+ *
+ *  Description: Hardware watchdog (WDOG1) supervision of arm() and the curve it follows. Once armed
+ *  it is fed by the scheduler's "watchdog" task while arm() waits for Zucrow, and only by
+ *  completed control ticks while the loop runs (the scheduler is not running then). If the follower
+ *  hangs - an SD flush that stalls, a blocking CAN wait, a wedged SPI transfer - the pre-timeout
+ *  interrupt kills (Safety::kill_from_interrupt(): ODrive idle frames from reserved CAN mailboxes and
+ *  the Zucrow panic line, nothing allocated or printed) and leaves a reason record with the loop stage
+ *  that was executing in RAM2, which neither the reset nor the startup code clears. The reset follows
+ *  WATCHDOG_PRETIMEOUT_MS later, the next boot prints the record.
+ *
+ *  Trade-off: WDOG1 can not be turned off once enabled, so the first arm() leaves it running until the
+ *  next reset. disarm() stretches the timeout to WATCHDOG_IDLE_TIMEOUT_MS and feeds it from a timer
+ *  interrupt, so commands that block without running the scheduler (homing, identify) can't trip it
+ *  between tests. Only a hang with interrupts masked still resets then, and a disarmed timeout never
+ *  kills. RTWDOG (WDOG3) could be turned off, but its interrupt leads the reset by only 255 bus clocks,
+ *  too little to get the idle frames onto CAN.
+ */
+
+#define WATCHDOG_KILL_MS 500             // unfed time before the kill, while armed
+#define WATCHDOG_PRETIMEOUT_MS 500       // from the kill to the reset
+#define WATCHDOG_IDLE_TIMEOUT_MS 120000  // once disarmed, longer than any blocking command (homing)
+#define WATCHDOG_FEED_INTERVAL_US 100000 // scheduler feeding outside the control loop, timer feeding while disarmed
+#define WATCHDOG_IDLE_FEED_PRIORITY 255  // lowest, so the shared PIT interrupt keeps the control loop's priority
+#define WATCHDOG_PRIORITY 32             // NVIC priority of the pre-timeout, preempts a hung tick or DMA interrupt
+
+namespace Watchdog {
+
+// prints and clears the reason record of a watchdog reset, registers the watchdog command
+void begin();
+
+// enables the watchdog on the first call, from then on it kills WATCHDOG_KILL_MS after the last feed
+void arm();
+
+// stretches the timeout to WATCHDOG_IDLE_TIMEOUT_MS and feeds it from a timer until the next arm()
+void disarm();
+
+// restarts the countdown, safe from the control tick and with interrupts masked
+void feed();
+
+} // namespace Watchdog
+
+#endif
@@ -10,6 +10,8 @@
 curve_header Loader::header;
 lerp_point_angle *Loader::lerp_angle_curve;
 lerp_point_thrust *Loader::lerp_thrust_curve;
+curve_segment *Loader::curve_segments;
+int Loader::num_segments;
 bool Loader::loaded_curve;
 
 void Loader::begin() {
@@ -23,12 +25,15 @@ void Loader::begin() {
 
 void Loader::load_curve_generic(bool serial, File *f) {
 
-  if (loaded_curve) {
-    extmem_free(lerp_angle_curve);
-    lerp_angle_curve = NULL;
-    extmem_free(lerp_thrust_curve);
-    lerp_thrust_curve = NULL;
-  }
+  // free the previous curve, or what is left of one that failed to compile (freeing NULL is a no-op)
+  extmem_free(lerp_angle_curve);
+  lerp_angle_curve = NULL;
+  extmem_free(lerp_thrust_curve);
+  lerp_thrust_curve = NULL;
+  extmem_free(curve_segments);
+  curve_segments = NULL;
+  num_segments = 0;
+  loaded_curve = false;
 
   auto receive = [=](char *buf, unsigned int len) {
     if (serial)
@@ -73,7 +78,41 @@ void Loader::load_curve_generic(bool serial, File *f) {
     }
   }
 
-  loaded_curve = true;
+  loaded_curve = compile_curve();
+}
+
+// builds curve_segments from the loaded points, returns false if the points can't be followed
+bool Loader::compile_curve() {
+  if (header.num_points < 2) {
+    Router::info("ERROR! A curve needs at least 2 points.");
+    return false;
+  }
+
+  num_segments = header.num_points - 1;
+  curve_segments = (curve_segment *)(extmem_calloc(num_segments, sizeof(curve_segment)));
+  for (int i = 0; i < num_segments; i++) {
+    curve_segment &s = curve_segments[i];
+    float t0 = header.is_thrust ? lerp_thrust_curve[i].time : lerp_angle_curve[i].time;
+    float t1 = header.is_thrust ? lerp_thrust_curve[i + 1].time : lerp_angle_curve[i + 1].time;
+    float a[2] = {header.is_thrust ? lerp_thrust_curve[i].thrust : lerp_angle_curve[i].lox_angle,
+                  header.is_thrust ? 0 : lerp_angle_curve[i].ipa_angle};
+    float b[2] = {header.is_thrust ? lerp_thrust_curve[i + 1].thrust : lerp_angle_curve[i + 1].lox_angle,
+                  header.is_thrust ? 0 : lerp_angle_curve[i + 1].ipa_angle};
+
+    if (t0 < 0 || t1 < t0) {
+      Router::info("ERROR! Curve point times must start at 0 or later and never decrease.");
+      return false;
+    }
+
+    s.start_us = lroundf(t0 * 1000000);
+    s.end_us = lroundf(t1 * 1000000);
+    for (int j = 0; j < 2; j++) {
+      s.value[j] = a[j];
+      // a zero length segment is skipped by the follower, so it jumps straight to the next point
+      s.slope[j] = s.end_us > s.start_us ? (b[j] - a[j]) / (s.end_us - s.start_us) : 0;
+    }
+  }
+  return true;
 }
 
 void Loader::load_curve_serial() {
@@ -129,30 +168,50 @@ void Loader::write_curve_sd() {
   Router::info("Wrote curve!");
 }
 
-int pt_zero_version = 2; // change this if the struct format changes
+int pt_zero_version = 3; // change this if the struct format changes
+struct PT_zero_entry {
+  float offset;
+  char serial[PT_CAL_SERIAL_SIZE]; // calibration the offset was taken under
+};
+
 struct PT_zero {
-  float lox_valve_upstream;
-  float lox_valve_downstream;
-  float lox_venturi_differential;
+  PT_zero_entry lox_valve_upstream;
+  PT_zero_entry lox_valve_downstream;
+  PT_zero_entry lox_venturi_differential;
 
-  float ipa_valve_upstream;
-  float ipa_valve_downstream;
-  float ipa_venturi_differential;
+  PT_zero_entry ipa_valve_upstream;
+  PT_zero_entry ipa_valve_downstream;
+  PT_zero_entry ipa_venturi_differential;
 
-  float chamber;
+  PT_zero_entry chamber;
 };
 
+static void save_entry(PT_zero_entry &entry, const PressureSensor &pt) {
+  entry.offset = pt.offset;
+  strncpy(entry.serial, pt.serial, PT_CAL_SERIAL_SIZE);
+}
+
+// an offset only holds for the calibration it was taken under, returns false if it was skipped
+static bool restore_entry(const PT_zero_entry &entry, PressureSensor &pt, const char *name) {
+  if (strncmp(entry.serial, pt.serial, PT_CAL_SERIAL_SIZE) != 0) {
+    Router::info("Skipped " + String(name) + ", its zero was taken under another calibration.");
+    return false;
+  }
+  pt.offset = entry.offset;
+  return true;
+}
+
 void Loader::save_pt_zero() {
-  PT_zero ptz;
-  ptz.lox_valve_upstream = PT::lox_valve_upstream.offset;
-  ptz.lox_valve_downstream = PT::lox_valve_downstream.offset;
-  ptz.lox_venturi_differential = PT::lox_venturi_differential.offset;
+  PT_zero ptz = {};
+  save_entry(ptz.lox_valve_upstream, PT::lox_valve_upstream);
+  save_entry(ptz.lox_valve_downstream, PT::lox_valve_downstream);
+  save_entry(ptz.lox_venturi_differential, PT::lox_venturi_differential);
 
-  ptz.ipa_valve_upstream = PT::ipa_valve_upstream.offset;
-  ptz.ipa_valve_downstream = PT::ipa_valve_downstream.offset;
-  ptz.ipa_venturi_differential = PT::ipa_venturi_differential.offset;
+  save_entry(ptz.ipa_valve_upstream, PT::ipa_valve_upstream);
+  save_entry(ptz.ipa_valve_downstream, PT::ipa_valve_downstream);
+  save_entry(ptz.ipa_venturi_differential, PT::ipa_venturi_differential);
 
-  ptz.chamber = PT::chamber.offset;
+  save_entry(ptz.chamber, PT::chamber);
 
   SD.remove("ptzero");
   File f = SDCard::open("ptzero", FILE_WRITE);
@@ -180,16 +239,22 @@ void Loader::restore_pt_zero() {
   f.read((char *)&ptz, sizeof(PT_zero));
   f.close();
 
-  PT::lox_valve_upstream.offset = ptz.lox_valve_upstream;
-  PT::lox_valve_downstream.offset = ptz.lox_valve_downstream;
-  PT::lox_venturi_differential.offset = ptz.lox_venturi_differential;
+  bool all = true;
+  all &= restore_entry(ptz.lox_valve_upstream, PT::lox_valve_upstream, "lox_valve_upstream");
+  all &= restore_entry(ptz.lox_valve_downstream, PT::lox_valve_downstream, "lox_valve_downstream");
+  all &= restore_entry(ptz.lox_venturi_differential, PT::lox_venturi_differential, "lox_venturi_differential");
 
-  PT::ipa_valve_upstream.offset = ptz.ipa_valve_upstream;
-  PT::ipa_valve_downstream.offset = ptz.ipa_valve_downstream;
-  PT::ipa_venturi_differential.offset = ptz.ipa_venturi_differential;
+  all &= restore_entry(ptz.ipa_valve_upstream, PT::ipa_valve_upstream, "ipa_valve_upstream");
+  all &= restore_entry(ptz.ipa_valve_downstream, PT::ipa_valve_downstream, "ipa_valve_downstream");
+  all &= restore_entry(ptz.ipa_venturi_differential, PT::ipa_venturi_differential, "ipa_venturi_differential");
 
-  PT::chamber.offset = ptz.chamber;
-  PT::zeroed_since_boot = true;
+  all &= restore_entry(ptz.chamber, PT::chamber, "chamber");
 
+  if (!all) {
+    // the skipped PTs keep the offsets they have, zero_pt_to_atm before arming
+    Router::info("Restored pt zero for the matching calibrations only.");
+    return;
+  }
+  PT::zeroed_since_boot = true;
   Router::info("Restored pt zero.");
 }
\ No newline at end of file
@@ -14,11 +14,23 @@
 #include <SD.h>
 #include <Curve.h>
 
+// one piece of the loaded curve, compiled so the follower can evaluate it with a multiply-add:
+// value[i] + slope[i] * (t_us - start_us) for start_us <= t_us < end_us
+// thrust curves use value[0] (lbf), angle curves use value[0] for lox and value[1] for ipa (degrees)
+struct curve_segment {
+  uint32_t start_us; // time since curve start
+  uint32_t end_us;
+  float value[2];    // value at start_us
+  float slope[2];    // change per microsecond
+};
+
 class Loader {
 public:
   static curve_header header;
   static lerp_point_angle *lerp_angle_curve;
   static lerp_point_thrust *lerp_thrust_curve;
+  static curve_segment *curve_segments; // header.num_points - 1 segments in EXTMEM
+  static int num_segments;
   static bool loaded_curve;
 
   static void begin(); // registers loader functions with the router
@@ -36,6 +48,7 @@ private:
   static void write_curve_sd();
 
   static void load_curve_generic(bool serial, File *f);
+  static bool compile_curve();
 };
 
 #endif // TADPOLE_SOFTWARE_LOADER_H
\ No newline at end of file
@@ -83,7 +83,7 @@ void SDCard::auto_cat() {
   if (f) {
     while (f.available()) {
       Serial.println(f.readStringUntil('\n'));
-      Serial.readStringUntil('\n'); // wait for enter
+      Router::read(1); // wait for enter
     }
     f.close();
   } else {
@@ -0,0 +1,105 @@
+#include "LogWriter.h"
+
+#include <Arduino.h>
+
+// keeps the compiler from moving buffer accesses across the head/tail updates (single core)
+static inline void barrier() { __asm__ volatile("" ::: "memory"); }
+
+bool LogWriter::open(const char *path, uint64_t preallocate_bytes, bool append_to_file) {
+  close(); // a caller that never closed the last file still gets it written out and trimmed
+  if (buffer == nullptr) {
+    buffer = (uint8_t *)extmem_malloc(size); // falls back to RAM without PSRAM
+  }
+  file = SD.sdfs.open(path, O_RDWR | O_CREAT | (append_to_file ? 0 : O_TRUNC));
+  if (!file || buffer == nullptr) {
+    return false;
+  }
+  if (append_to_file) {
+    file.seekEnd();
+  } else if (preallocate_bytes > 0) {
+    file.preAllocate(preallocate_bytes); // best effort, a fragmented card still logs, just slower
+  }
+
+  uint32_t start = file.curPosition() % LOG_SECTOR_SIZE;
+  head = start;
+  tail = start;
+  stats = {};
+  stats.buffer_size = size;
+  return true;
+}
+
+void LogWriter::close() {
+  if (!file) {
+    return;
+  }
+  flush();
+  file.truncate(); // give back what the preallocation reserved past the last record
+  file.close();
+}
+
+bool LogWriter::append(const void *data, uint32_t len) {
+  uint32_t h = head;
+  uint32_t used = h - tail;
+  if (buffer == nullptr || len > size - used) {
+    stats.dropped++;
+    return false;
+  }
+
+  uint32_t offset = h & (size - 1);
+  uint32_t first = min(len, size - offset);
+  memcpy(buffer + offset, data, first);
+  memcpy(buffer, (const uint8_t *)data + first, len - first);
+  barrier();
+  head = h + len;
+
+  stats.records++;
+  stats.high_water = max(stats.high_water, used + len);
+  return true;
+}
+
+// writes buffer bytes from tail up to end, in two pieces if they wrap. returns bytes written
+uint32_t LogWriter::write_range(uint32_t end) {
+  uint32_t t = tail;
+  uint32_t len = end - t;
+  if ((int32_t)len <= 0 || !file) { // also after a flush() left tail past the last sector boundary
+    return 0;
+  }
+
+  uint32_t offset = t & (size - 1);
+  uint32_t first = min(len, size - offset);
+  uint32_t start_us = micros();
+  file.write(buffer + offset, first);
+  if (len > first) {
+    file.write(buffer, len - first);
+  }
+  stats.max_write_us = max(stats.max_write_us, micros() - start_us);
+  stats.bytes_written += len;
+  unsynced = true;
+
+  barrier();
+  tail = t + len;
+  return len;
+}
+
+void LogWriter::service() {
+  write_range(head & ~(uint32_t)(LOG_SECTOR_SIZE - 1)); // whole sectors only
+}
+
+void LogWriter::sync() {
+  if (unsynced && file) {
+    file.sync();
+    unsynced = false;
+  }
+}
+
+void LogWriter::flush() {
+  write_range(head);
+  sync();
+}
+
+Log_Writer_Stats LogWriter::getStats() const {
+  noInterrupts();
+  Log_Writer_Stats s = stats;
+  interrupts();
+  return s;
+}
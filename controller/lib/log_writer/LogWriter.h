@@ -0,0 +1,77 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+/*
+ * LogWriter.h
+ *
+ *  Description: Buffered SD card log file. A producer (the control tick for curve logs, the console for
+ *  log.txt) append()s to a ring buffer in EXTMEM, which only copies bytes and never waits on the card.
+ *  service(), called from the background, writes whole 512 byte sectors to the file as they fill, so
+ *  the card only sees sector aligned writes and nothing is committed until sync(), flush() or close().
+ *  When the card stalls for longer than the ring can absorb, appends are dropped and counted instead
+ *  of blocking the producer; the high water mark shows how close a run came to that.
+ *
+ *  One producer and one consumer. append() may run in an interrupt that preempts service(), but
+ *  never two append()s at once or service() inside an interrupt.
+ */
+
+#include <SD.h>
+#include <stdint.h>
+
+#define LOG_SECTOR_SIZE 512
+
+struct Log_Writer_Stats {
+  uint32_t buffer_size;   // bytes
+  uint32_t high_water;    // most bytes waiting for the card at once
+  uint32_t records;       // appends that made it into the buffer
+  uint32_t dropped;       // appends lost because the buffer was full
+  uint64_t bytes_written; // to the card
+  uint32_t max_write_us;  // longest single write to the card
+};
+
+class LogWriter {
+public:
+  // buffer_size must be a power of 2 and a multiple of LOG_SECTOR_SIZE
+  explicit LogWriter(uint32_t buffer_size) : size(buffer_size) {}
+
+  // opens path, truncating it unless append_to_file, after closing any file still open. preallocate_bytes
+  // reserves contiguous clusters up front so the file system never has to search for free space mid-run, 0 skips it
+  bool open(const char *path, uint64_t preallocate_bytes = 0, bool append_to_file = false);
+
+  // flushes, trims any unused preallocation and closes the file
+  void close();
+
+  bool isOpen() { return file.isOpen(); }
+
+  // copies len bytes into the buffer, false (and counted as dropped) if they don't fit
+  bool append(const void *data, uint32_t len);
+
+  // writes the full sectors waiting in the buffer, background only
+  void service();
+
+  // commits the sectors service() wrote (file size, FAT) so they survive a power loss, background only.
+  // leaves the partial sector in the buffer, cheap when nothing changed
+  void sync();
+
+  // writes everything in the buffer and commits it to the card, background only. cheap when nothing changed
+  void flush();
+
+  Log_Writer_Stats getStats() const;
+
+private:
+  uint32_t write_range(uint32_t end);
+
+  FsFile file;
+  uint8_t *buffer = nullptr;
+  const uint32_t size;
+
+  // byte counts that only ever increase, buffer offset is the count mod size. they start at the
+  // file position mod LOG_SECTOR_SIZE so sector boundaries in the file land on boundaries in the buffer
+  volatile uint32_t head = 0; // appended, written by the producer
+  volatile uint32_t tail = 0; // written to the card, written by service()
+
+  bool unsynced = false; // written since the last sync
+  Log_Writer_Stats stats = {};
+};
+
+#endif
@@ -14,15 +14,27 @@ namespace Driver {
 
 #define LOX_ODRIVE_CAN_ID 1
 #define IPA_ODRIVE_CAN_ID 2
+#define MAX_ODRIVE_NODES 64 // CANSimple node ids are the top 6 bits of the 11 bit id
 
 char loxName[4] = "LOX";
 char ipaName[4] = "IPA";
-ODrive loxODrive(LOX_ODRIVE_CAN_ID, loxName);
-ODrive ipaODrive(IPA_ODRIVE_CAN_ID, ipaName);
+ODrive loxODrive(LOX_ODRIVE_CAN_ID, loxName, ODRIVE_KILL_MB_LOX);
+ODrive ipaODrive(IPA_ODRIVE_CAN_ID, ipaName, ODRIVE_KILL_MB_IPA);
 
+// axis for each node id, filled by add_node() before CAN is started
+ODrive *nodes[MAX_ODRIVE_NODES] = {};
+
+void add_node(ODrive &odrive) {
+  nodes[odrive.getNodeId()] = &odrive;
+}
+
+// CAN receive interrupt, hands each frame only to the axis it came from
 void onCanMessage(const CanMsg &msg) {
-  onReceive(msg, loxODrive);
-  onReceive(msg, ipaODrive);
+  uint32_t node_id = msg.id >> ODriveCAN::kNodeIdShift;
+  if (msg.flags.extended || node_id >= MAX_ODRIVE_NODES || nodes[node_id] == nullptr) {
+    return;
+  }
+  onReceive(msg, *nodes[node_id]);
 }
 
 void printODriveInfo() {
@@ -33,6 +45,8 @@ void printODriveInfo() {
 }
 
 void begin() {
+  add_node(loxODrive);
+  add_node(ipaODrive);
   setup_can(onCanMessage);
   Router::add({printODriveInfo, "get_odrive_info"});
 
@@ -78,11 +92,10 @@ void begin() {
   Router::add({[&]() { loxODrive.enable(); ipaODrive.enable(); }, "enable"});
 
 #if (ENABLE_ODRIVE_COMM)
-  Router::info("Connecting to lox odrive...");
-  loxODrive.checkConnection();
-
-  Router::info("Connecting to ipa odrive...");
-  ipaODrive.checkConnection();
+  Router::info("Connecting to odrives...");
+  loxODrive.connect();
+  ipaODrive.connect();
+  Scheduler::run_until([] { return !loxODrive.connecting() && !ipaODrive.connecting(); });
 
   printODriveInfo();
 #endif
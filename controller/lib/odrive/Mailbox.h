@@ -0,0 +1,70 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+/*
+ * Mailbox.h
+ *
+ *  Description: Holds the latest message of one type from one ODrive and when it arrived. The CAN
+ *  receive interrupt is the only writer, anything else may read. write() makes the sequence number
+ *  odd, copies the message and makes it even again; read() copies the message and retries if the
+ *  sequence number was odd or changed meanwhile, so a reader never sees half of two different frames
+ *  and neither side masks interrupts.
+ *
+ *  A reader that preempts the CAN receive interrupt would spin forever on an odd sequence number, so
+ *  mailboxes must only be read at a lower priority than the CAN interrupt (the control tick is).
+ */
+
+#include <stdint.h>
+
+template <typename T>
+class Mailbox {
+public:
+  // CAN receive interrupt only
+  void write(const T &msg, uint32_t time_us) {
+    seq = seq + 1;
+    barrier();
+    value = msg;
+    stamp_us = time_us;
+    barrier();
+    seq = seq + 1;
+  }
+
+  // latest message, a default T until the first one arrives
+  T read() const {
+    T copy;
+    uint32_t start;
+    do {
+      start = seq;
+      barrier();
+      copy = value;
+      barrier();
+    } while ((start & 1) || start != seq);
+    return copy;
+  }
+
+  // messages received since boot
+  uint32_t count() const { return seq / 2; }
+
+  // microseconds since the latest message arrived, UINT32_MAX if none has
+  uint32_t age_us(uint32_t now_us) const {
+    uint32_t start;
+    uint32_t received;
+    do {
+      start = seq;
+      barrier();
+      received = stamp_us;
+      barrier();
+    } while ((start & 1) || start != seq);
+    return start == 0 ? UINT32_MAX : now_us - received;
+  }
+
+private:
+  // single core, so keeping the compiler from moving the copy across the sequence updates is enough
+  static void barrier() { __asm__ volatile("" ::: "memory"); }
+
+  volatile uint32_t seq = 0;
+  T value;
+  uint32_t stamp_us = 0; // micros() when value arrived
+};
+
+#endif
@@ -9,14 +9,14 @@ FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> can_intf; // can interface
 void setup_can(_MB_ptr handler) {
   can_intf.begin();
   can_intf.setBaudRate(CAN_BAUDRATE);
+  can_intf.setMB(ODRIVE_KILL_MB_LOX, RX, STD); // reserved, see idleFromInterrupt()
+  can_intf.setMB(ODRIVE_KILL_MB_IPA, RX, STD);
   can_intf.enableMBInterrupts();
   can_intf.onReceive(handler);
 }
 
-ODrive::ODrive(uint32_t can_id, char name[4])
-    : ODriveCAN(wrap_can_intf(can_intf), can_id) {
-
-  ODriveCAN::onStatus(onHeartbeatCB, &this->odrive_status);
+ODrive::ODrive(uint32_t can_id, char name[4], FLEXCAN_MAILBOX kill_mb)
+    : ODriveCAN(wrap_can_intf(can_intf), can_id), killMailbox(kill_mb) {
 
   // crappy way of doing this, bu it is three characters, so it is fine
   this->name[0] = name[0];
@@ -25,54 +25,82 @@ ODrive::ODrive(uint32_t can_id, char name[4])
   this->name[3] = '\0';
 }
 
-// Called every time a Heartbeat message arrives from the ODrive
-void onHeartbeatCB(Heartbeat_msg_t &msg, void *user_data) {
-  ODriveUserData *odrv_user_data = static_cast<ODriveUserData *>(user_data);
-  odrv_user_data->last_heartbeat = msg;
-  odrv_user_data->received_heartbeat = true;
+void ODrive::idleFromInterrupt() {
+  Set_Axis_State_msg_t msg;
+  msg.Axis_Requested_State = AXIS_STATE_IDLE;
+
+  CAN_message_t frame;
+  frame.id = (getNodeId() << kNodeIdShift) | msg.cmd_id;
+  frame.len = msg.msg_length;
+  msg.encode_buf(frame.buf);
+
+  can_intf.setMB(killMailbox, TX); // was a receive mailbox, nothing else transmits from it
+  can_intf.write(killMailbox, frame);
 }
 
 /**
  * Checks if communication with ODrive is available by requesting the current state
- * Runs in a while loop until the ODrive is connected
+ * Runs as a scheduler task every 10 ms until the ODrive is connected, so both ODrives connect at once
  */
-void ODrive::checkConnection() {
+void ODrive::connect() {
 #if (ENABLE_ODRIVE_COMM)
-  while (this->odrive_status.received_heartbeat && this->odrive_status.last_heartbeat.Axis_State == AXIS_STATE_UNDEFINED) {
-    Router::info("No response from ODrive...");
-    delay(100);
-  }
-  Router::info("Setting odrive to closed loop control...");
-  while (this->odrive_status.last_heartbeat.Axis_State != AXIS_STATE_CLOSED_LOOP_CONTROL) {
-    ODriveCAN::clearErrors();
-    ODriveCAN::setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
-    delay(10);
+  if (connecting()) {
+    return;
   }
-  ODriveCAN::setControllerMode(CONTROL_MODE_POSITION_CONTROL, INPUT_MODE_POS_FILTER);
+  connectPolls = 0;
+  closedLoopRequested = false;
+  connectTask = Scheduler::every(name, 10000, [this] { connectStep(); }, 200);
 #endif
 }
 
+void ODrive::connectStep() {
+  uint8_t state = last_heartbeat.read().Axis_State;
+  if (state == AXIS_STATE_CLOSED_LOOP_CONTROL) {
+    ODriveCAN::setControllerMode(CONTROL_MODE_POSITION_CONTROL, INPUT_MODE_POS_FILTER);
+    Scheduler::cancel(connectTask);
+    return;
+  }
+  if (last_heartbeat.count() > 0 && state == AXIS_STATE_UNDEFINED) {
+    if (connectPolls++ % 10 == 0) {
+      Router::info_no_newline(name);
+      Router::info(": No response from ODrive...");
+    }
+    return;
+  }
+  if (!closedLoopRequested) {
+    Router::info_no_newline(name);
+    Router::info(": Setting odrive to closed loop control...");
+    closedLoopRequested = true;
+  }
+  ODriveCAN::clearErrors();
+  ODriveCAN::setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
+}
+
 /**
  * Set the position for the odrive to control flow through valve.
  * @param pos value to be sent to odrive (valid values are from `MIN_ODRIVE_POS` to `MAX_ODRIVE_POS`).
+ * @param vel_ff expected valve velocity at `pos` in turns/s, sent as the position loop's velocity feed-forward
+ * so the valve does not have to fall behind a moving command before it starts following it.
  */
-void ODrive::setPos(float pos) {
+void ODrive::setPos(float pos, float vel_ff) {
   posCmd = pos;
   if (pos < MIN_ODRIVE_POS) {
-    Router::info_no_newline("Clipping pos to ");
-    Router::info(MIN_ODRIVE_POS);
+    clipCount++; // no printing here, setPos runs in the control tick
     pos = MIN_ODRIVE_POS;
+    vel_ff = 0; // held at the limit, don't push past it
   }
 
   if (pos > MAX_ODRIVE_POS) {
-    Router::info_no_newline("Clipping pos to ");
-    Router::info(MAX_ODRIVE_POS);
+    clipCount++;
     pos = MAX_ODRIVE_POS;
+    vel_ff = 0;
   }
+  vel_ff = constrain(vel_ff, -MAX_ODRIVE_VEL_FF, MAX_ODRIVE_VEL_FF); // a larger value would overflow the int16
+  velFFCmd = vel_ff;
   pos = 0.25 - pos; // invert command send to motor
 
 #if (ENABLE_ODRIVE_COMM)
-  ODriveCAN::setPosition(pos);
+  ODriveCAN::setPosition(pos, -vel_ff);
 #endif
 }
 
@@ -127,6 +155,22 @@ void ODrive::identify() {
   Router::info("Done");
 }
 
+/**
+ * Copies the latest telemetry received from the ODrive into position, velocity, voltage, current, temperature
+ * and feedbackAge
+ */
+void ODrive::updateTelemetry() {
+#if (ENABLE_ODRIVE_COMM)
+  feedbackAge = encoderAge(); // before the read, so a message arriving in between can only make it an overestimate
+  Get_Encoder_Estimates_msg_t enc = last_enc_msg.read();
+  position = 0.25 - enc.Pos_Estimate;
+  velocity = enc.Vel_Estimate;
+  voltage = last_vc_msg.read().Bus_Voltage;
+  current = last_amp_msg.read().Iq_Measured;
+  temperature = last_temp_msg.read().Motor_Temperature;
+#endif
+}
+
 /**
  * Returns a CSV string containing the ODrive Telemetry information, in the following format:
  * position,velocity,voltage,current
@@ -135,12 +179,7 @@ char *ODrive::getTelemetryCSV() {
   telemetryCSV.clear();
 
 #if (ENABLE_ODRIVE_COMM)
-  position = 0.25 - this->last_enc_msg.Pos_Estimate;
-  velocity = this->last_enc_msg.Vel_Estimate;
-  voltage = this->last_vc_msg.Bus_Voltage;
-  current = this->last_amp_msg.Iq_Measured;
-  temperature = this->last_temp_msg.Motor_Temperature;
-
+  updateTelemetry();
   telemetryCSV << position << "," << velocity << "," << voltage << "," << current;
 #else
   telemetryCSV << "pos" << "," << "vel" << ","
@@ -195,7 +234,7 @@ void ODrive::setPosConsoleCmd() {
 
   setPos(pos);
   Router::info("Position set - watch angle readout.");
-  ZucrowInterface::report_angles_for_five_seconds();
+  ZucrowInterface::report_angles();
 }
 
 void ODrive::hardStopHoming() { // @ Xander
@@ -254,7 +293,7 @@ void ODrive::hardStopHoming() { // @ Xander
   delay(100);
   enable();
   Router::info("State Reset");
-  ZucrowInterface::report_angles_for_five_seconds();
+  ZucrowInterface::report_angles();
 }
 
 void ODrive::kill() {
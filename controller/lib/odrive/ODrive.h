@@ -3,15 +3,16 @@
 
 #include "Router.h"
 #include "CString.h"
+#include "Scheduler.h"
 #include "ODriveCAN.h"
 #include <FlexCAN_T4.h>
 #include "ODriveFlexCAN.hpp"
 #define CAN_BAUDRATE 500000
 
-struct ODriveUserData {
-  Heartbeat_msg_t last_heartbeat;
-  bool received_heartbeat = false;
-};
+// CAN3 mailboxes reserved for idling the odrives from the watchdog interrupt. setup_can() makes them receive
+// mailboxes so write() never hands them out, a kill then can't collide with the write() it preempted
+#define ODRIVE_KILL_MB_LOX MB14
+#define ODRIVE_KILL_MB_IPA MB15
 
 #define ENABLE_ODRIVE_COMM (true)
 
@@ -23,6 +24,11 @@ struct ODriveUserData {
 #define ODRIVE_BAD_STATE (-5)
 #define ODRIVE_THREAD_ENDED_PREMATURELY (-6)
 
+// cyclic message rates configured on the odrives (axis0.config.can.*_msg_rate_ms in odrive_conf)
+#define ODRIVE_ENCODER_INTERVAL_US 10000
+#define ODRIVE_HEARTBEAT_INTERVAL_US 100000
+#define ODRIVE_STALE_INTERVALS 3 // a message stream is stale once this many intervals pass without one
+
 #define ODRIVE_TELEM_HEADER ("position,velocity,voltage,current,temperature")
 
 #define INT_BUFFER_SIZE (50)
@@ -30,8 +36,8 @@ struct ODriveUserData {
 #define MIN_THRUST (0)
 #define MAX_ODRIVE_POS (80.0 / 360.0) // max angle = 80 deg
 #define MIN_ODRIVE_POS (25.0 / 360.0) // min angle = 25 deg
+#define MAX_ODRIVE_VEL_FF (32.0f)     // turns/s, Set_Input_Pos carries Vel_FF as an int16 of 0.001 turns/s (max 32.767)
 
-void onHeartbeatCB(Heartbeat_msg_t &msg, void *user_data);
 void setup_can(_MB_ptr handler);
 
 class ODrive : public ODriveCAN {
@@ -52,6 +58,12 @@ private:
    */
   float posCmd;
 
+  /*
+   * The velocity feed-forward sent with the last position command (turns/s, valve direction)
+   * Modified only in `setPos()`, 0 when the command was clipped
+   */
+  float velFFCmd = 0;
+
   /*
    * The last error the odrive encontered
    * Modified only by `checkErrors()`
@@ -83,12 +95,25 @@ private:
   int fwVersionMajor;
   int fwVersionMinor;
 
+  /*
+   * Scheduler task of `connect()`, -1 before it was started
+   * connectPolls counts the runs that found no response, the warning is printed on every 10th
+   */
+  int connectTask = -1;
+  unsigned long connectPolls = 0;
+  bool closedLoopRequested = false;
+
+  // reserved mailbox of `idleFromInterrupt()`
+  FLEXCAN_MAILBOX killMailbox;
+
+  void connectStep();
+
 public:
-  ODrive(uint32_t can_id, char[4]);
+  ODrive(uint32_t can_id, char[4], FLEXCAN_MAILBOX kill_mb);
 
   /*
    * The last known position, velocity, voltage, and current of the ODrive
-   * Modified by `getTelemetryCSV()`
+   * Modified by `updateTelemetry()` and `getTelemetryCSV()`
    */
   float position;
   float velocity;
@@ -96,14 +121,32 @@ public:
   float current;
   float temperature;
 
-  // stores data sent back from the odrive - modified by onHeartbeat() and onFeedback()
-  ODriveUserData odrive_status;
+  /*
+   * Age of the encoder estimate behind `position` and `velocity` in microseconds, UINT32_MAX if none arrived yet
+   * Modified by `updateTelemetry()`
+   */
+  uint32_t feedbackAge;
+
+  /*
+   * Number of position commands clipped to the MIN_ODRIVE_POS - MAX_ODRIVE_POS range by `setPos()`
+   * Reset by the caller, setPos does not print because it runs in the control tick
+   */
+  unsigned long clipCount = 0;
 
-  void checkConnection();
+  // starts a scheduler task that brings the ODrive into closed loop control and ends once it is
+  void connect();
+  bool connecting() { return Scheduler::pending(connectTask); }
 
-  void setPos(float);
+  void setPos(float pos, float vel_ff = 0);
+
+  /*
+   * Requests AXIS_STATE_IDLE from an interrupt that may have preempted a CAN write (FlexCAN_T4 is not
+   * reentrant). Goes straight to the reserved mailbox, bypassing the library's mailbox search and queue
+   */
+  void idleFromInterrupt();
   void setPosConsoleCmd();
   float getLastPosCmd() { return posCmd; }
+  float getLastVelFF() { return velFFCmd; }
   void printCmdPos() { Router::info(getLastPosCmd()); }
 
   int checkErrors();
@@ -115,6 +158,13 @@ public:
   int getActiveError() { return activeError; }
   int getDisarmReason() { return disarmReason; }
 
+  // time since the latest message of each cyclic stream (us), UINT32_MAX if none arrived yet
+  uint32_t encoderAge() { return last_enc_msg.age_us(micros()); }
+  uint32_t heartbeatAge() { return last_heartbeat.age_us(micros()); }
+  bool encoderStale() { return encoderAge() > ODRIVE_ENCODER_INTERVAL_US * ODRIVE_STALE_INTERVALS; }
+  bool heartbeatStale() { return heartbeatAge() > ODRIVE_HEARTBEAT_INTERVAL_US * ODRIVE_STALE_INTERVALS; }
+
+  void updateTelemetry();
   char *getTelemetryCSV();
   void printTelemetryCSV() {
     Router::info(ODRIVE_TELEM_HEADER);
@@ -148,36 +148,45 @@ void ODriveCAN::onReceive(uint32_t id, uint8_t length, const uint8_t *data) {
 #endif // DEBUG
   if (node_id_ != (id >> ODriveCAN::kNodeIdShift))
     return;
+  uint32_t now_us = micros();
   if ((id & ODriveCAN::kCmdIdBits) == requested_msg_id_) {
     memcpy(buffer_, data, length);
+    __asm__ volatile("" ::: "memory"); // awaitMsg() may read buffer_ as soon as the request is cleared
     requested_msg_id_ = REQUEST_PENDING;
   }
 
   switch (id & ODriveCAN::kCmdIdBits) {
   case Get_Encoder_Estimates_msg_t::cmd_id: {
-    last_enc_msg.decode_buf(data);
+    Get_Encoder_Estimates_msg_t msg;
+    msg.decode_buf(data);
+    last_enc_msg.write(msg, now_us);
     break;
   }
   case Get_Bus_Voltage_Current_msg_t::cmd_id: {
-    last_vc_msg.decode_buf(data);
+    Get_Bus_Voltage_Current_msg_t msg;
+    msg.decode_buf(data);
+    last_vc_msg.write(msg, now_us);
     break;
   }
   case Get_Iq_msg_t::cmd_id: {
-    last_amp_msg.decode_buf(data);
+    Get_Iq_msg_t msg;
+    msg.decode_buf(data);
+    last_amp_msg.write(msg, now_us);
     break;
   }
   case Get_Temperature_msg_t::cmd_id: {
-    last_temp_msg.decode_buf(data);
+    Get_Temperature_msg_t msg;
+    msg.decode_buf(data);
+    last_temp_msg.write(msg, now_us);
     break;
   }
 
   case Heartbeat_msg_t::cmd_id: {
     Heartbeat_msg_t status;
     status.decode_buf(data);
+    last_heartbeat.write(status, now_us);
     if (axis_state_callback_ != nullptr)
       axis_state_callback_(status, axis_state_user_data_);
-    else
-      Serial.println("missing callback");
     break;
   }
   default: {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ODriveEnums.h"
+#include "Mailbox.h"
 #include "can_helpers.hpp"
 #include "can_simple_messages.hpp"
 
@@ -34,6 +35,11 @@ public:
   ODriveCAN(const ODriveCanIntfWrapper &can_intf, uint32_t node_id)
       : can_intf_(can_intf), node_id_(node_id) {};
 
+  static const uint8_t kNodeIdShift = 5;
+  static const uint8_t kCmdIdBits = 0x1F;
+
+  uint32_t getNodeId() const { return node_id_; }
+
   /**
    * @brief Clear all errors on the ODrive.
    *
@@ -205,7 +211,7 @@ public:
   }
 
   /**
-   * @brief Processes received CAN messages for the ODrive.
+   * @brief Processes received CAN messages for the ODrive. Runs in the CAN receive interrupt.
    */
   void onReceive(uint32_t id, uint8_t length, const uint8_t *data);
 
@@ -300,10 +306,12 @@ public:
     return true;
   }
 
-  Get_Encoder_Estimates_msg_t last_enc_msg;
-  Get_Bus_Voltage_Current_msg_t last_vc_msg;
-  Get_Iq_msg_t last_amp_msg;
-  Get_Temperature_msg_t last_temp_msg;
+  // latest cyclic messages, written by onReceive() in the CAN receive interrupt
+  Mailbox<Get_Encoder_Estimates_msg_t> last_enc_msg;
+  Mailbox<Get_Bus_Voltage_Current_msg_t> last_vc_msg;
+  Mailbox<Get_Iq_msg_t> last_amp_msg;
+  Mailbox<Get_Temperature_msg_t> last_temp_msg;
+  Mailbox<Heartbeat_msg_t> last_heartbeat;
 
 private:
   bool awaitMsg(uint16_t timeout_ms);
@@ -315,9 +323,6 @@ private:
 
   uint8_t buffer_[8];
 
-  static const uint8_t kNodeIdShift = 5;
-  static const uint8_t kCmdIdBits = 0x1F;
-
   void *axis_state_user_data_;
 
   void (*axis_state_callback_)(Heartbeat_msg_t &feedback, void *user_data) = nullptr;
@@ -4,6 +4,8 @@ void onReceive(const CAN_message_t& msg, ODriveCAN& odrive) {
     odrive.onReceive(msg.id | (msg.flags.extended ? 0x80000000 : 0), msg.len, msg.buf);
 }
 
+// FlexCAN_T4 only queues received frames for events() once events() has been called. It never is, so
+// frames go straight from the receive interrupt to the mailboxes and there is nothing to pump
 void pumpEvents(FlexCAN_T4_Base& can_intf) {
-    can_intf.events();
+    (void)can_intf;
 }
\ No newline at end of file
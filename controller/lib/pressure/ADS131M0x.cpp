@@ -1,7 +1,6 @@
 #include "Arduino.h"
 #include "ADS131M0x.h"
 #include "SPI_Fixed.h"
-#include "SPI_Demux.h"
 
 // #define DEBUG_PRESSURE_CRC
 
@@ -17,8 +16,7 @@ int32_t ADS131M0x::val32Ch0 = 0x7FFFFF;
  * @brief Construct a new ADS131M0x::ADS131M0x object
  *
  */
-ADS131M0x::ADS131M0x(int demuxAddr) {
-  this->demuxAddr = demuxAddr;
+ADS131M0x::ADS131M0x(int demuxAddr) : spi("pt", demuxAddr, ADS131M0X_SPI_CLOCK, SPI_MODE1, SPI_PRIORITY_HIGH) {
 }
 
 /**
@@ -34,8 +32,7 @@ uint8_t ADS131M0x::writeRegister(uint8_t address, uint16_t value) {
   uint8_t bytesRcv;
   uint16_t cmd = 0;
 
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  spi.begin();
   delayMicroseconds(2);
 
   cmd = (CMD_WRITE_REG) | (address << 7) | 0;
@@ -80,8 +77,7 @@ uint8_t ADS131M0x::writeRegister(uint8_t address, uint16_t value) {
 #endif
 
   delayMicroseconds(2);
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
+  spi.end();
 
   addressRcv = (res & REGMASK_CMD_READ_REG_ADDRESS) >> 7;
   bytesRcv = (res & REGMASK_CMD_READ_REG_BYTES);
@@ -104,8 +100,7 @@ uint16_t ADS131M0x::readRegister(uint8_t address) {
 
   cmd = CMD_READ_REG | (address << 7 | 0);
 
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  spi.begin();
   delayMicroseconds(2);
 
   SPI1.transfer16(cmd);
@@ -146,8 +141,7 @@ uint16_t ADS131M0x::readRegister(uint8_t address) {
 #endif
 
   delayMicroseconds(2);
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
+  spi.end();
 
   return data;
 }
@@ -461,8 +455,7 @@ bool ADS131M0x::resetDevice(void) {
   uint8_t x2 = 0;
   uint16_t ris = 0;
 
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  spi.begin();
   delayMicroseconds(2);
 
   x = SPI1.transfer(0x00);
@@ -484,8 +477,7 @@ bool ADS131M0x::resetDevice(void) {
   ris = ((x << 8) | x2);
 
   delayMicroseconds(2);
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
+  spi.end();
 
   if (RSP_RESET_OK == ris) {
     return true;
@@ -497,123 +489,104 @@ bool ADS131M0x::resetDevice(void) {
 /// @param
 /// @return
 adcOutput ADS131M0x::readADC(void) {
-  uint8_t x = 0;
-  uint8_t x2 = 0;
-  uint8_t x3 = 0;
-  int32_t aux;
-  adcOutput res;
-
-  uint8_t crc_buf[9];
-
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  uint8_t frame[ADS131M0X_FRAME_BYTES];
 
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  crc_buf[0] = x;
-  crc_buf[1] = x2;
-  crc_buf[2] = x3;
-
-  res.status = ((x << 8) | x2);
+  spi.begin();
 
-  // read CH0 --------
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  crc_buf[3] = x;
-  crc_buf[4] = x2;
-  crc_buf[5] = x3;
-
-  aux = (((x << 16) | (x2 << 8) | x3) & 0x00FFFFFF);
-  if (aux > 0x7FFFFF) {
-    res.ch0 = ((~(aux) & 0x00FFFFFF) + 1) * -1;
-  } else {
-    res.ch0 = aux;
+  for (int i = 0; i < ADS131M0X_FRAME_BYTES; i++) {
+    frame[i] = SPI1.transfer(0x00);
   }
 
-  // NOTE - THIS SHOULD NOT BE HERE! - Robert Nies
-  // // faster!!!
-  // SPI1.transfer(0x00);
-  // SPI1.transfer(0x00);
-  // SPI1.transfer(0x00);
+  spi.end();
 
-  // read CH1 --------
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  crc_buf[6] = x;
-  crc_buf[7] = x2;
-  crc_buf[8] = x3;
+  return parseFrame(frame);
+}
 
-  aux = (((x << 16) | (x2 << 8) | x3) & 0x00FFFFFF);
+// converts a 24 bit two's complement word to int32
+static int32_t word_to_int32(const uint8_t *word) {
+  int32_t aux = (((word[0] << 16) | (word[1] << 8) | word[2]) & 0x00FFFFFF);
   if (aux > 0x7FFFFF) {
-    res.ch1 = ((~(aux) & 0x00FFFFFF) + 1) * -1;
-  } else {
-    res.ch1 = aux;
+    return ((~(aux) & 0x00FFFFFF) + 1) * -1;
   }
+  return aux;
+}
 
-#ifndef IS_M02
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  aux = (((x << 16) | (x2 << 8) | x3) & 0x00FFFFFF);
-  if (aux > 0x7FFFFF) {
-    res.ch2 = ((~(aux) & 0x00FFFFFF) + 1) * -1;
-  } else {
-    res.ch2 = aux;
+// CRC-16-CCITT (polynomial 0x1021) of every byte value, so the frame crc takes one lookup per byte
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+/// @brief CRC-16-CCITT with initial value 0xFFFF, the ADS131M0x's default crc
+uint16_t ADS131M0x::crc16(const uint8_t *data, int len) {
+  uint16_t crc = 0xFFFF;
+  for (int i = 0; i < len; i++) {
+    crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ data[i]];
   }
+  return crc;
+}
 
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  aux = (((x << 16) | (x2 << 8) | x3) & 0x00FFFFFF);
-  if (aux > 0x7FFFFF) {
-    res.ch3 = ((~(aux) & 0x00FFFFFF) + 1) * -1;
-  } else {
-    res.ch3 = aux;
-  }
+/// @brief Decode a data frame read from the ADC (status, channels, crc - 3 bytes each) and check its crc
+/// @param frame ADS131M0X_FRAME_BYTES bytes, as clocked out of the ADC
+/// @return
+adcOutput ADS131M0x::parseFrame(const uint8_t *frame) {
+  adcOutput res;
+  res.status = (frame[0] << 8) | frame[1];
+  res.ch1_fresh = res.status & REGMASK_STATUS_DRDY1;
+  res.ch0 = word_to_int32(&frame[3]);
+  res.ch1 = word_to_int32(&frame[6]);
+#ifndef IS_M02
+  res.ch2 = word_to_int32(&frame[9]);
+  res.ch3 = word_to_int32(&frame[12]);
 #endif
 
-  x = SPI1.transfer(0x00);
-  x2 = SPI1.transfer(0x00);
-  x3 = SPI1.transfer(0x00);
-  aux = (x << 8) | x2;
-
-  uint16_t crc = 0xFFFF;
-  for (int i = 0; i < 9; i++) {
-    crc ^= (crc_buf[i] << 8);
-    for (int j = 0; j < 8; j++) {
-      if (crc & 0x8000) {
-        crc = (crc << 1) ^ 0x1021;
-      } else {
-        crc <<= 1;
-      }
-    }
-  }
-  res.crc_ok = crc == aux;
+  // the crc covers every word before the crc word
+  const int crc_len = ADS131M0X_FRAME_BYTES - 3;
+  uint16_t received_crc = (frame[crc_len] << 8) | frame[crc_len + 1];
+  uint16_t crc = crc16(frame, crc_len);
+  res.crc_ok = crc == received_crc;
 
 #ifdef DEBUG_PRESSURE_CRC
+  for (int i = 0; i < crc_len; i++) {
+    Serial.print(frame[i], HEX);
+    Serial.print("-");
+  }
+  Serial.print(received_crc, HEX);
   if (!res.crc_ok) {
-    for (int i = 0; i < 9; i++) {
-      Serial.print(crc_buf[i], HEX);
-      Serial.print("-");
-    }
-    Serial.print(aux, HEX);
-
     Serial.print(" <-> ");
     Serial.print(crc, HEX);
-  } else {
-    for (int i = 0; i < 9; i++) {
-      Serial.print(crc_buf[i], HEX);
-      Serial.print("-");
-    }
-    Serial.print(aux, HEX);
   }
 #endif
 
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
-
   return res;
-}
\ No newline at end of file
+}
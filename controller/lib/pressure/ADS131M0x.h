@@ -5,6 +5,7 @@
 
 #include "Arduino.h"
 #include "SPI_Fixed.h"
+#include "SPIBus.h"
 
 // define for 2-channel version ADS131M02
 #define IS_M02
@@ -12,6 +13,15 @@
 // no delay after CS-active at adc_read
 // #define NO_CS_DELAY
 
+#define ADS131M0X_SPI_CLOCK 4000000
+
+// bytes in a data frame: status, one word per channel, crc - 24 bit words
+#ifdef IS_M02
+#define ADS131M0X_FRAME_BYTES 12
+#else
+#define ADS131M0X_FRAME_BYTES 18
+#endif
+
 struct adcOutput {
   uint16_t status;
   int32_t ch0;
@@ -21,6 +31,7 @@ struct adcOutput {
   int32_t ch3;
 #endif
   bool crc_ok;
+  bool ch1_fresh; // DRDY1 in the status word: ch1 is a new conversion, not the previous one read again
 };
 
 #define DRDY_STATE_LOGIC_HIGH 0 // DEFAULS
@@ -283,12 +294,16 @@ public:
 
   uint16_t isResetOK(void);
   adcOutput readADC(void);
+  static adcOutput parseFrame(const uint8_t *frame); // decodes a frame clocked out without readADC (e.g. by DMA)
+  static uint16_t crc16(const uint8_t *data, int len);
+  int getDemuxAddr() { return spi.getDemuxAddr(); }
+  SPIDevice &getSPIDevice() { return spi; }
 
 private:
   uint8_t writeRegister(uint8_t address, uint16_t value);
   void writeRegisterMasked(uint8_t address, uint16_t value, uint16_t mask);
   uint16_t readRegister(uint8_t address);
 
-  int demuxAddr;
+  SPIDevice spi;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "PTCalibration.h"
+
+#include <Arduino.h>
+
+#include "PressureSensor.h"
+#include "PTSweep.h"
+#include "Router.h"
+#include "Scheduler.h"
+#include "SDCard.h"
+
+namespace PTCal {
+
+namespace {
+struct Installed_PT {
+  const char *name;
+  PressureSensor *pt;
+};
+
+const Installed_PT installed[] = {
+    {"lox_valve_upstream", &PT::lox_valve_upstream},
+    {"lox_valve_downstream", &PT::lox_valve_downstream},
+    {"lox_venturi_differential", &PT::lox_venturi_differential},
+    {"ipa_valve_upstream", &PT::ipa_valve_upstream},
+    {"ipa_valve_downstream", &PT::ipa_valve_downstream},
+    {"ipa_venturi_differential", &PT::ipa_venturi_differential},
+    {"chamber", &PT::chamber},
+};
+#define NUM_INSTALLED (sizeof(installed) / sizeof(installed[0]))
+
+pt_cal_record records[PT_CAL_MAX_RECORDS];
+int num_records;
+
+PressureSensor *sampled_pt;
+double volts_sum;
+int volts_count;
+int volts_failures;
+
+const Installed_PT *find_pt(const char *name) {
+  for (unsigned i = 0; i < NUM_INSTALLED; i++) {
+    if (strcmp(installed[i].name, name) == 0) {
+      return &installed[i];
+    }
+  }
+  Router::info("Unknown PT.");
+  return nullptr;
+}
+
+pt_cal_record *find_serial(const char *serial) {
+  for (int i = 0; i < num_records; i++) {
+    if (strncmp(records[i].serial, serial, PT_CAL_SERIAL_SIZE) == 0) {
+      return &records[i];
+    }
+  }
+  return nullptr;
+}
+
+// reads the calibration file into records, which are left empty if there is none
+bool read_file() {
+  num_records = 0;
+  if (!SD.exists(PT_CAL_FILE) && SD.exists(PT_CAL_TMP_FILE)) {
+    SD.rename(PT_CAL_TMP_FILE, PT_CAL_FILE); // power was lost between the remove and the rename in write_file()
+  }
+  File f = SDCard::open(PT_CAL_FILE, FILE_READ);
+  if (!f) {
+    return false;
+  }
+  pt_cal_header header;
+  bool ok = f.read((char *)&header, sizeof(header)) == sizeof(header) && header.magic == PT_CAL_MAGIC;
+  if (ok && header.version != CURRENT_PTCAL_VERSION) {
+    Router::info("PT calibration file is from another version, ignoring it.");
+    ok = false;
+  }
+  if (ok && header.num_records <= PT_CAL_MAX_RECORDS &&
+      f.read((char *)records, header.num_records * sizeof(pt_cal_record)) == (int)(header.num_records * sizeof(pt_cal_record))) {
+    num_records = header.num_records;
+  } else if (ok) {
+    Router::info("PT calibration file is damaged, ignoring it.");
+    ok = false;
+  }
+  f.close();
+  return ok;
+}
+
+// writes a temporary file and renames it into place, so a power loss never leaves the card without a calibration
+bool write_file() {
+  SD.remove(PT_CAL_TMP_FILE); // FILE_WRITE appends
+  File f = SDCard::open(PT_CAL_TMP_FILE, FILE_WRITE);
+  if (!f) {
+    Router::info("Could not write the PT calibration file.");
+    return false;
+  }
+  pt_cal_header header;
+  header.num_records = num_records;
+  size_t records_size = num_records * sizeof(pt_cal_record);
+  bool ok = f.write((char *)&header, sizeof(header)) == sizeof(header) &&
+            f.write((char *)records, records_size) == records_size;
+  f.close();
+  if (!ok) {
+    SD.remove(PT_CAL_TMP_FILE);
+    Router::info("Could not write the PT calibration file.");
+    return false;
+  }
+  SD.remove(PT_CAL_FILE); // FAT won't rename over an existing file
+  if (!SD.rename(PT_CAL_TMP_FILE, PT_CAL_FILE)) {
+    Router::info("Could not replace the PT calibration file.");
+    return false;
+  }
+  return true;
+}
+
+PressureSensor *on_board(uint8_t demux_addr) {
+  for (unsigned i = 0; i < NUM_INSTALLED; i++) {
+    if (installed[i].pt->getDemuxAddr() == demux_addr) {
+      return installed[i].pt;
+    }
+  }
+  return nullptr;
+}
+
+void apply(const pt_cal_record &r) {
+  PressureSensor *pt = on_board(r.demux_addr);
+  if (pt) {
+    pt->setCalibration(r.coeffs, r.degree, r.serial);
+    pt->offset = 0; // the old offset belonged to the old calibration
+    PT::zeroed_since_boot = false;
+  }
+}
+
+// puts the transducer on pt's board, taking any other transducer off it
+void install(pt_cal_record &r, const Installed_PT &pt) {
+  PressureSensor *previous = r.demux_addr != pt.pt->getDemuxAddr() ? on_board(r.demux_addr) : nullptr;
+  if (previous) {
+    previous->resetCalibration(); // the transducer left that board
+    previous->offset = 0;
+    PT::zeroed_since_boot = false;
+  }
+  for (int i = 0; i < num_records; i++) {
+    if (records[i].demux_addr == pt.pt->getDemuxAddr()) {
+      records[i].demux_addr = PT_CAL_NOT_INSTALLED;
+    }
+  }
+  r.demux_addr = pt.pt->getDemuxAddr();
+}
+
+// one sweep for the averaged calibration point, a scheduler task
+void sample() {
+  if (PTSweep::pending()) {
+    PTSweep::finish(); // someone left a sweep running, start() would refuse
+  }
+  if (!PTSweep::start() || !PTSweep::finish() || !sampled_pt->getLastValid()) {
+    volts_failures++;
+    return;
+  }
+  volts_sum += sampled_pt->getLastVolts();
+  volts_count++;
+}
+
+// averages PT_CAL_SAMPLES sweeps of one transducer, NAN (and says why) if they could not be collected
+float average_volts(PressureSensor *pt) {
+  sampled_pt = pt;
+  volts_sum = 0;
+  volts_count = 0;
+  volts_failures = 0;
+  uint32_t started_ms = millis();
+  int task = Scheduler::every("pt_cal", 1000, sample, PT_SWEEP_TIMEOUT_US);
+  Scheduler::run_until([task, started_ms] {
+    return volts_count >= PT_CAL_SAMPLES || volts_failures >= PT_CAL_MAX_FAILURES || !Scheduler::pending(task) ||
+           millis() - started_ms > PT_CAL_TIMEOUT_MS;
+  });
+  bool no_slot = !Scheduler::pending(task);
+  Scheduler::cancel(task);
+  if (volts_count >= PT_CAL_SAMPLES) {
+    return volts_sum / volts_count;
+  }
+  Router::info(no_slot ? "No free task slot." : "Sweeps timed out or read invalid, check the PT.");
+  return NAN;
+}
+
+// least squares polynomial through the points, normal equations solved by gaussian elimination.
+// returns false if the points can't determine a polynomial of that degree
+bool fit(const float *x, const float *y, int n, int degree, float *coeffs) {
+  const int m = degree + 1;
+  double a[PT_CAL_MAX_DEGREE + 1][PT_CAL_MAX_DEGREE + 2] = {};
+  for (int k = 0; k < n; k++) {
+    double powers[2 * PT_CAL_MAX_DEGREE + 1];
+    powers[0] = 1;
+    for (int j = 1; j <= 2 * degree; j++) {
+      powers[j] = powers[j - 1] * x[k];
+    }
+    for (int r = 0; r < m; r++) {
+      for (int c = 0; c < m; c++) {
+        a[r][c] += powers[r + c];
+      }
+      a[r][m] += powers[r] * y[k];
+    }
+  }
+
+  for (int col = 0; col < m; col++) {
+    int pivot = col;
+    for (int r = col + 1; r < m; r++) {
+      if (fabs(a[r][col]) > fabs(a[pivot][col])) {
+        pivot = r;
+      }
+    }
+    if (fabs(a[pivot][col]) < 1e-12) {
+      return false;
+    }
+    for (int c = 0; c <= m; c++) {
+      double t = a[col][c];
+      a[col][c] = a[pivot][c];
+      a[pivot][c] = t;
+    }
+    for (int r = 0; r < m; r++) {
+      if (r != col) {
+        double f = a[r][col] / a[col][col];
+        for (int c = col; c <= m; c++) {
+          a[r][c] -= f * a[col][c];
+        }
+      }
+    }
+  }
+  for (int i = 0; i <= PT_CAL_MAX_DEGREE; i++) {
+    coeffs[i] = i < m ? a[i][m] / a[i][i] : 0;
+  }
+  return true;
+}
+
+// replaces the record of r's serial number or adds it, then saves and applies it
+bool store(pt_cal_record &r) {
+  pt_cal_record *existing = find_serial(r.serial);
+  if (existing == nullptr) {
+    if (num_records >= PT_CAL_MAX_RECORDS) {
+      Router::info("PT calibration file is full, remove transducers with `install_pt`.");
+      return false;
+    }
+    existing = &records[num_records++];
+  }
+  *existing = r;
+  if (!write_file()) {
+    return false;
+  }
+  apply(r);
+  return true;
+}
+
+const Installed_PT *read_pt() {
+  Router::info_no_newline("PT (");
+  for (unsigned i = 0; i < NUM_INSTALLED; i++) {
+    Router::info_no_newline(i ? ", " : "");
+    Router::info_no_newline(installed[i].name);
+  }
+  Router::info_no_newline("): ");
+  return find_pt(Router::read(40).c_str());
+}
+
+String read_serial() {
+  Router::info_no_newline("Transducer serial number: ");
+  return Router::read(PT_CAL_SERIAL_SIZE - 1);
+}
+
+void calibrate() {
+  const Installed_PT *pt = read_pt();
+  if (pt == nullptr) {
+    return;
+  }
+  String serial = read_serial();
+  if (serial.length() == 0) {
+    Router::info("A serial number is required.");
+    return;
+  }
+  read_file();
+
+  float volts[PT_CAL_MAX_POINTS];
+  float psi[PT_CAL_MAX_POINTS];
+  int n = 0;
+  char line[80];
+  while (n < PT_CAL_MAX_POINTS) {
+    Router::info_no_newline("Apply a known pressure and enter it in psi, or `done`: ");
+    String s = Router::read(20);
+    if (s == "done") {
+      break;
+    }
+    if (std::sscanf(s.c_str(), "%f", &psi[n]) != 1) {
+      Router::info("Could not convert input to a float.");
+      continue;
+    }
+    volts[n] = average_volts(pt->pt);
+    if (isnan(volts[n])) {
+      Router::info("Not continuing.");
+      return;
+    }
+    snprintf(line, sizeof(line), "%.2f psi at %.5f V", psi[n], volts[n]);
+    Router::info(line);
+    n++;
+  }
+  if (n < 2) {
+    Router::info("At least two points are needed, not continuing.");
+    return;
+  }
+
+  int max_degree = min(n - 1, PT_CAL_MAX_DEGREE);
+  snprintf(line, sizeof(line), "Polynomial degree (1-%d): ", max_degree);
+  Router::info_no_newline(line);
+  int degree;
+  if (std::sscanf(Router::read(5).c_str(), "%d", &degree) != 1 || degree < 1 || degree > max_degree) {
+    Router::info("Invalid degree, not continuing.");
+    return;
+  }
+
+  pt_cal_record r = {};
+  strncpy(r.serial, serial.c_str(), PT_CAL_SERIAL_SIZE - 1);
+  pt_cal_record *previous = find_serial(r.serial);
+  r.demux_addr = previous ? previous->demux_addr : PT_CAL_NOT_INSTALLED; // install() moves it
+  r.degree = degree;
+  if (!fit(volts, psi, n, degree, r.coeffs)) {
+    Router::info("Fit failed, the points are too close together.");
+    return;
+  }
+  snprintf(line, sizeof(line), "psi = %g + %g v + %g v^2 + %g v^3", r.coeffs[0], r.coeffs[1], r.coeffs[2], r.coeffs[3]);
+  Router::info(line);
+  for (int i = 0; i < n; i++) {
+    float fitted = PressureSensor::polynomial(r.coeffs, r.degree, volts[i]);
+    snprintf(line, sizeof(line), "%10.2f psi: fit %10.2f, error %+.3f", psi[i], fitted, fitted - psi[i]);
+    Router::info(line);
+  }
+
+  Router::info_no_newline("Type `y` and press enter to save and use this calibration. ");
+  if (Router::read(5) != "y") {
+    Router::info("Calibration discarded.");
+    return;
+  }
+  install(r, *pt);
+  if (store(r)) {
+    Router::info("Calibration saved, zero the PTs before the next test.");
+  }
+}
+
+void install_cmd() {
+  const Installed_PT *pt = read_pt();
+  if (pt == nullptr) {
+    return;
+  }
+  String serial = read_serial();
+  read_file();
+  pt_cal_record *r = find_serial(serial.c_str());
+  if (r == nullptr) {
+    Router::info("No calibration for that serial number, run calibrate_pt.");
+    return;
+  }
+  install(*r, *pt);
+  if (write_file()) {
+    apply(*r);
+    Router::info("Installed, zero the PTs before the next test.");
+  }
+}
+
+void print() {
+  char line[160];
+  for (unsigned i = 0; i < NUM_INSTALLED; i++) {
+    const float *c = installed[i].pt->getCalibration();
+    snprintf(line, sizeof(line), "%-25s %-15s psi = %g + %g v + %g v^2 + %g v^3, offset %.2f", installed[i].name,
+             installed[i].pt->serial[0] ? installed[i].pt->serial : "(built-in)", c[0], c[1], c[2], c[3],
+             installed[i].pt->offset);
+    Router::info(line);
+  }
+}
+} // namespace
+
+void begin() {
+  Router::add({calibrate, "calibrate_pt"});
+  Router::add({install_cmd, "install_pt"});
+  Router::add({print, "pt_cal"});
+
+  int loaded = 0;
+  if (read_file()) {
+    for (int i = 0; i < num_records; i++) {
+      if (records[i].demux_addr != PT_CAL_NOT_INSTALLED) {
+        apply(records[i]);
+        loaded++;
+      }
+    }
+  }
+  Router::info_no_newline("Loaded ");
+  Router::info_no_newline(loaded);
+  Router::info(" PT calibrations, the other PTs use built-in slopes.");
+}
+
+} // namespace PTCal
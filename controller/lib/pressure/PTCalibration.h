@@ -0,0 +1,55 @@
+#ifndef PT_CALIBRATION_H
+#define PT_CALIBRATION_H
+
+/*
+ * PTCalibration.h
+ *
+ *  Description: Per-transducer PT calibrations on the SD card, so swapping a transducer needs a
+ *  calibration, not a reflash. A calibration is a polynomial of up to PT_CAL_MAX_DEGREE from the
+ *  transducer output in volts (0-10 V) to psi, fitted by least squares to pressures applied during
+ *  `calibrate_pt`. Records are keyed by the transducer serial number and remember which PT board the
+ *  transducer is installed on; `install_pt` moves an already calibrated transducer to another board.
+ *  PTs without a record keep the built-in slope from PressureSensor.cpp.
+ *
+ *  The zero offset (zero_pt_to_atm, save_pt_zero) still applies on top of the calibration.
+ */
+
+#include <stdint.h>
+
+#define CURRENT_PTCAL_VERSION 1 // UPDATE THIS IF THE FILE LAYOUT CHANGES - it will invalidate saved calibrations
+#define PT_CAL_MAGIC 0x4C435450 // "PTCL" in a little endian file
+#define PT_CAL_FILE "ptcal"
+#define PT_CAL_TMP_FILE "ptcal.tmp" // written first, then renamed over PT_CAL_FILE
+
+#define PT_CAL_MAX_DEGREE 3
+#define PT_CAL_SERIAL_SIZE 16
+#define PT_CAL_MAX_RECORDS 32     // transducers remembered, installed or not
+#define PT_CAL_MAX_POINTS 16      // pressures applied during one calibration
+#define PT_CAL_SAMPLES 500        // sweeps averaged per calibration point, at 1 kHz
+#define PT_CAL_MAX_FAILURES 50    // timed out sweeps or invalid readings before a calibration point fails
+#define PT_CAL_TIMEOUT_MS 2000    // a calibration point fails if it has not collected PT_CAL_SAMPLES by then
+#define PT_CAL_NOT_INSTALLED 0xFF // demux_addr of a transducer that is on the shelf
+
+// start of the calibration file, followed by num_records pt_cal_records
+typedef struct {
+  uint32_t magic = PT_CAL_MAGIC;
+  uint16_t version = CURRENT_PTCAL_VERSION;
+  uint16_t num_records;
+} pt_cal_header;
+
+typedef struct {
+  char serial[PT_CAL_SERIAL_SIZE]; // null terminated
+  uint8_t demux_addr;              // PT board the transducer is installed on
+  uint8_t degree;
+  uint16_t reserved;
+  float coeffs[PT_CAL_MAX_DEGREE + 1]; // psi = coeffs[0] + coeffs[1] v + coeffs[2] v^2 + ..., v in volts
+} pt_cal_record;
+
+namespace PTCal {
+
+// registers the calibration commands and loads the calibrations of the installed transducers
+void begin();
+
+} // namespace PTCal
+
+#endif
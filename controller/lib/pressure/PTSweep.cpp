@@ -0,0 +1,109 @@
+#include "PTSweep.h"
+
+#include <Arduino.h>
+#include <EventResponder.h>
+
+#include "PressureSensor.h"
+#include "SPIBus.h"
+#include "SPI_Fixed.h"
+
+#define PT_SWEEP_COUNT 7
+
+namespace PTSweep {
+
+unsigned long timeouts = 0;
+
+namespace {
+PressureSensor *sensors[PT_SWEEP_COUNT] = {
+    &PT::lox_valve_upstream, &PT::lox_valve_downstream, &PT::lox_venturi_differential,
+    &PT::ipa_valve_upstream, &PT::ipa_valve_downstream, &PT::ipa_venturi_differential,
+    &PT::chamber,
+};
+
+uint8_t frames[PT_SWEEP_COUNT][ADS131M0X_FRAME_BYTES];
+EventResponder frame_done;
+volatile int current = 0;       // frame being clocked out
+volatile bool running = false;  // set by start(), cleared by the last completion interrupt
+bool collected = true;          // finish() has converted the frames of the last sweep
+uint32_t started_us = 0;
+uint32_t last_sample_us = 0;
+
+void begin_frame(int i) {
+  sensors[i]->getSPIDevice().select();
+  SPI1.transfer(nullptr, frames[i], ADS131M0X_FRAME_BYTES, frame_done);
+}
+
+// DMA completion interrupt, chains the next PT
+void on_frame_done(EventResponderRef) {
+  if (!running) {
+    return; // completion that raced abort()
+  }
+  sensors[current]->getSPIDevice().deselect();
+  if (current + 1 < PT_SWEEP_COUNT) {
+    current = current + 1;
+    begin_frame(current);
+  } else {
+    sensors[0]->getSPIDevice().release();
+    running = false;
+  }
+}
+
+// stops a sweep that hung, frees SPI1 for the DAC and TCs and lets the next start() retry
+void abort() {
+  noInterrupts();
+  if (running) {
+    SPI1.abortTransfer();
+    sensors[current]->getSPIDevice().deselect();
+    sensors[0]->getSPIDevice().release();
+    running = false;
+  }
+  interrupts();
+  collected = true;
+}
+} // namespace
+
+bool start() {
+  if (!collected) {
+    return false;
+  }
+  frame_done.attachImmediate(on_frame_done);
+  collected = false;
+  running = true;
+  current = 0;
+  started_us = micros();
+
+  sensors[0]->getSPIDevice().acquire(); // all PTs share the settings, one transaction for the sweep
+  begin_frame(0);
+  return true;
+}
+
+bool pending() {
+  return !collected;
+}
+
+bool finish() {
+  if (collected) {
+    return true;
+  }
+  uint32_t wait_start = micros();
+  while (running) {
+    if (micros() - wait_start > PT_SWEEP_TIMEOUT_US) {
+      timeouts++;
+      abort();
+      return false;
+    }
+  }
+
+  for (int i = 0; i < PT_SWEEP_COUNT; i++) {
+    sensors[i]->getPressure(ADS131M0x::parseFrame(frames[i]));
+  }
+  last_sample_us = started_us;
+  collected = true;
+  return true;
+}
+
+uint32_t sample_time_us() {
+  return last_sample_us;
+}
+
+} // namespace PTSweep
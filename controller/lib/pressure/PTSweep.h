@@ -0,0 +1,40 @@
+#ifndef PT_SWEEP_H
+#define PT_SWEEP_H
+
+/*
+ * PTSweep.h
+ *
+ *  Description: Reads all PTs in one DMA chain. start() selects the first PT and hands its frame to
+ *  the SPI1 DMA engine; each completion interrupt deselects it, selects the next PT and starts the
+ *  next frame, so the CPU is free for the whole sweep. finish() waits for the chain and converts the
+ *  frames, the new values are then available from PressureSensor::getLastPressure().
+ *
+ *  SPI1 belongs to the sweep while it runs - nothing else may use SPI1 (TCs, Zucrow DAC) between
+ *  start() and finish().
+ */
+
+#include <stdint.h>
+
+#define PT_SWEEP_TIMEOUT_US 500 // longest finish() waits, a full sweep takes ~200 us
+
+namespace PTSweep {
+
+// begins a sweep of all PTs, returns immediately. returns false if one is already running
+bool start();
+
+// true between start() and finish()
+bool pending();
+
+// waits for the running sweep and converts its frames. returns false if the sweep timed out,
+// in which case the sweep is aborted, SPI1 is freed and the PTs keep their previous values
+bool finish();
+
+// micros() when the last finished sweep started - the sample time of its values
+uint32_t sample_time_us();
+
+// sweeps that did not complete within PT_SWEEP_TIMEOUT_US since boot
+extern unsigned long timeouts;
+
+} // namespace PTSweep
+
+#endif
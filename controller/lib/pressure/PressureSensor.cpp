@@ -1,28 +1,62 @@
 #include "PressureSensor.h"
 #include "SPI_Demux.h"
 #include "Router.h"
+#include "Scheduler.h"
+#include "PTSweep.h"
 
 // #define PRINT_PT_MV // enable to print adc mv measurement (for calibration)
 
+// ADC counts to volts at the transducer: 2.4 V over 24 bits, inverted by the board, and 0-1 V at the ADC is 0-10 V
+#define PT_VOLTS_PER_COUNT (-24.0f / 16777216.0f)
+
 PressureSensor::PressureSensor(int demuxAddr, float slope) : ADS131M0x(demuxAddr) {
-  this->slope = slope;
+  this->builtin_slope = slope;
+  resetCalibration();
   this->offset = 0;
   this->last_good_value = 0;
+  this->last_volts = 0;
+}
+
+void PressureSensor::setCalibration(const float *coeffs, int degree, const char *serial) {
+  cal_degree = degree;
+  for (int i = 0; i <= PT_CAL_MAX_DEGREE; i++) {
+    cal[i] = i <= degree ? coeffs[i] : 0;
+  }
+  strncpy(this->serial, serial, PT_CAL_SERIAL_SIZE - 1);
+  this->serial[PT_CAL_SERIAL_SIZE - 1] = '\0';
+}
+
+void PressureSensor::resetCalibration() {
+  const float linear[] = {0, builtin_slope};
+  setCalibration(linear, 1, "");
+}
+
+// horner form, float only
+float PressureSensor::polynomial(const float *coeffs, int degree, float volts) {
+  float p = coeffs[degree];
+  for (int i = degree - 1; i >= 0; i--) {
+    p = p * volts + coeffs[i];
+  }
+  return p;
 }
 
 void PressureSensor::begin() {
   resetDevice();
+  setOsr(PT_OSR);
 }
 
 // returns the absolute pressure
-// first the incoming PT data is mapped to 0 to 10v
-// this value is multiplied by the slope (should be approximately PT range / 10) and a small linear offset is added
-// to find these values, measure a few points of **ABSOLUTE** pressure and the corresponding voltages
-// plot as voltage on x and pressure on y, and find the line of best fit
+// first the incoming PT data is converted to the transducer's 0 to 10v
+// this value goes through the transducer's calibration polynomial (`calibrate_pt`, or the built-in slope of
+// approximately PT range / 10) and the zero offset is added
 float PressureSensor::getPressure() {
-  adcOutput out = this->readADC();
+  return getPressure(this->readADC());
+}
+
+float PressureSensor::getPressure(const adcOutput &out) {
   if (!out.crc_ok) {
-    Serial.print(" crc err ");
+    crc_errors++; // counted, not printed - this runs in the control tick
+    last_valid = false;
     return last_good_value;
   }
 
@@ -30,28 +64,21 @@ float PressureSensor::getPressure() {
   //   Serial.print(out.status, HEX);
   //   Serial.print(" rdy err ");
   // }
-  float voltage = out.ch1;
-  voltage *= 2.4 / 1;
-  voltage /= -pow(2, 24);
+  float volts = out.ch1 * PT_VOLTS_PER_COUNT;
 
 #ifdef PRINT_PT_MV
-  Serial.print(voltage * 1000);
+  Serial.print(volts * 100); // at the ADC
   Serial.print(" mV ");
 #endif
-  float rval = map(voltage, 0, 1, 0, 10) * slope + offset;
+  float rval = polynomial(cal, cal_degree, volts) + offset;
+  last_volts = volts;
   last_good_value = rval;
-  return rval;
-}
-
-void PressureSensor::zero(float target) {
-  offset = 0;
-  float sum = 0;
-  int samples = 100;
-  for (int i = 0; i < samples; i++) {
-    sum += getPressure();
-    delay(10);
+  last_valid = true;
+  last_fresh = out.ch1_fresh;
+  if (!last_fresh) {
+    repeated_samples++;
   }
-  offset = target - sum / samples;
+  return rval;
 }
 
 namespace PT {
@@ -66,6 +93,84 @@ PressureSensor ipa_venturi_differential(SPI_DEVICE_PT_IPA_VENTURI_DIFFERENTIAL,
 
 PressureSensor chamber(SPI_DEVICE_PT_CHAMBER, 51.07);
 
+namespace {
+struct Zero_Target {
+  PressureSensor *pt;
+  float pressure; // what the PT should read while zeroing
+  const char *label;
+};
+
+const Zero_Target zero_targets[] = {
+    {&lox_valve_upstream, 14.7, "LOX Valve Upstream Offset (expected -38): "},
+    {&lox_valve_downstream, 14.7, "LOX Valve Downstream Offset (expected -30): "},
+    {&ipa_valve_upstream, 14.7, "IPA Valve Upstream Offset (expected -70): "},
+    {&ipa_valve_downstream, 14.7, "IPA Valve Downstream Offset (expected -78): "},
+    {&chamber, 14.7, "Chamber Offset (expected -10): "},
+    {&lox_venturi_differential, 0, "LOX Diffy Offset (-1): "},
+    {&ipa_venturi_differential, 0, "IPA Diffy Offset (-12): "},
+};
+#define NUM_ZERO_TARGETS (sizeof(zero_targets) / sizeof(zero_targets[0]))
+
+// running mean and variance (Welford), one pass and no large sums that lose float precision
+struct Zero_Stats {
+  float mean;
+  float m2; // sum of squared differences from the mean
+};
+
+Zero_Stats zero_stats[NUM_ZERO_TARGETS];
+int zero_count;
+int zero_failures;
+
+// one sweep of all PTs, a scheduler task while zero() waits
+void zero_sample() {
+  if (PTSweep::pending()) {
+    PTSweep::finish(); // someone left a sweep running, start() would refuse
+  }
+  if (!PTSweep::start() || !PTSweep::finish()) {
+    zero_failures++; // timed out, the PTs still hold the previous sweep
+    return;
+  }
+  for (unsigned i = 0; i < NUM_ZERO_TARGETS; i++) {
+    if (!zero_targets[i].pt->getLastValid()) {
+      zero_failures++; // bad CRC or a dead PT, don't average it in
+      return;
+    }
+  }
+  zero_count++;
+  for (unsigned i = 0; i < NUM_ZERO_TARGETS; i++) {
+    Zero_Stats &z = zero_stats[i];
+    float x = zero_targets[i].pt->getLastPressure();
+    float delta = x - z.mean;
+    z.mean += delta / zero_count;
+    z.m2 += delta * (x - z.mean);
+  }
+}
+
+// sets the oversampling ratio of every PT until the next boot
+void osr_cmd() {
+  Router::info_no_newline("OSR (0-7 for 128 to 16384, data rate 4 kHz at 3): ");
+  int osr;
+  if (std::sscanf(Router::read(5).c_str(), "%d", &osr) != 1 || osr < OSR_128 || osr > OSR_16384) {
+    Router::info("Invalid OSR, not continuing.");
+    return;
+  }
+  set_osr(osr);
+  Router::info("OSR set on all PTs.");
+}
+} // namespace
+
+unsigned long repeated_sample_count() {
+  return lox_valve_upstream.repeated_samples + lox_valve_downstream.repeated_samples +
+         lox_venturi_differential.repeated_samples + ipa_valve_upstream.repeated_samples +
+         ipa_valve_downstream.repeated_samples + ipa_venturi_differential.repeated_samples + chamber.repeated_samples;
+}
+
+unsigned long crc_error_count() {
+  return lox_valve_upstream.crc_errors + lox_valve_downstream.crc_errors + lox_venturi_differential.crc_errors +
+         ipa_valve_upstream.crc_errors + ipa_valve_downstream.crc_errors + ipa_venturi_differential.crc_errors +
+         chamber.crc_errors;
+}
+
 void begin() {
   lox_valve_upstream.begin();
   lox_valve_downstream.begin();
@@ -78,41 +183,66 @@ void begin() {
   chamber.begin();
 
   Router::add({zero, "zero_pt_to_atm"});
+  Router::add({osr_cmd, "pt_osr"});
+}
+
+void set_osr(uint16_t osr) {
+  for (PressureSensor *pt : {&lox_valve_upstream, &lox_valve_downstream, &lox_venturi_differential, &ipa_valve_upstream,
+                             &ipa_valve_downstream, &ipa_venturi_differential, &chamber}) {
+    pt->setOsr(osr);
+  }
 }
 
 void zero() {
   Router::info_no_newline("Zeroing ...");
-  lox_valve_upstream.zero(14.7);
-  lox_valve_downstream.zero(14.7);
-  lox_venturi_differential.zero(0);
-
-  ipa_valve_upstream.zero(14.7);
-  ipa_valve_downstream.zero(14.7);
-  ipa_venturi_differential.zero(0);
-
-  chamber.zero(14.7);
-  zeroed_since_boot = true;
+  float previous[NUM_ZERO_TARGETS];
+  for (unsigned i = 0; i < NUM_ZERO_TARGETS; i++) {
+    previous[i] = zero_targets[i].pt->offset;
+    zero_targets[i].pt->offset = 0;
+    zero_stats[i] = {};
+  }
+  zero_count = 0;
+  zero_failures = 0;
+  uint32_t started_ms = millis();
+  int task = Scheduler::every("pt_zero", PT_ZERO_INTERVAL_US, zero_sample, PT_SWEEP_TIMEOUT_US);
+  Scheduler::run_until([task, started_ms] {
+    return zero_count >= PT_ZERO_SAMPLES || zero_failures >= PT_ZERO_MAX_FAILURES || !Scheduler::pending(task) ||
+           millis() - started_ms > PT_ZERO_TIMEOUT_MS;
+  });
+  bool no_slot = !Scheduler::pending(task);
+  Scheduler::cancel(task);
+  if (zero_count < PT_ZERO_SAMPLES) {
+    if (no_slot) {
+      Router::info(" failed, no free task slot.");
+    } else {
+      Router::info_no_newline(" failed, ");
+      Router::info_no_newline(zero_failures);
+      Router::info(" sweeps timed out or read invalid. Offsets kept.");
+    }
+    for (unsigned i = 0; i < NUM_ZERO_TARGETS; i++) {
+      zero_targets[i].pt->offset = previous[i];
+    }
+    return;
+  }
   Router::info(" finished!");
 
-  Router::info_no_newline("LOX Valve Upstream Offset (expected -38): ");
-  Router::info(lox_valve_upstream.offset);
-
-  Router::info_no_newline("LOX Valve Downstream Offset (expected -30): ");
-  Router::info(lox_valve_downstream.offset);
-
-  Router::info_no_newline("IPA Valve Upstream Offset (expected -70): ");
-  Router::info(ipa_valve_upstream.offset);
-
-  Router::info_no_newline("IPA Valve Downstream Offset (expected -78): ");
-  Router::info(ipa_valve_downstream.offset);
-
-  Router::info_no_newline("Chamber Offset (expected -10): ");
-  Router::info(chamber.offset);
-
-  Router::info_no_newline("LOX Diffy Offset (-1): ");
-  Router::info(lox_venturi_differential.offset);
-
-  Router::info_no_newline("IPA Diffy Offset (-12): ");
-  Router::info(ipa_venturi_differential.offset);
+  bool all_good = true;
+  char line[64];
+  for (unsigned i = 0; i < NUM_ZERO_TARGETS; i++) {
+    const Zero_Target &t = zero_targets[i];
+    float stddev = sqrtf(zero_stats[i].m2 / (zero_count - 1));
+    bool noisy = stddev > PT_ZERO_MAX_NOISE * t.pt->full_scale();
+    t.pt->offset = noisy ? previous[i] : t.pressure - zero_stats[i].mean;
+    all_good = all_good && !noisy;
+
+    Router::info_no_newline(t.label);
+    snprintf(line, sizeof(line), "%.2f, noise %.3f psi rms%s", t.pt->offset, stddev, noisy ? " - TOO NOISY, offset kept" : "");
+    Router::info(line);
+  }
+  if (all_good) {
+    zeroed_since_boot = true;
+  } else {
+    Router::info("Not zeroed, check the noisy PTs and zero again.");
+  }
 }
 } // namespace PT
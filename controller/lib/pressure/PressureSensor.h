@@ -4,24 +4,58 @@
 // See docs/Sensor File.md for info
 
 #include "ADS131M0x.h"
+#include "PTCalibration.h"
+
+// ADC oversampling ratio, OSR_* from ADS131M0x.h. data rate = 8.192 MHz / (2 * OSR): OSR_1024 gives 4 kHz, so
+// every 1 kHz control tick finds a new conversion and its sample is at most 250 us old when the sweep reads it
+#define PT_OSR OSR_1024
+
+#define PT_ZERO_SAMPLES 1000
+#define PT_ZERO_INTERVAL_US 1000 // one sweep of all PTs per sample, so zeroing takes one second
+#define PT_ZERO_MAX_NOISE 0.001  // largest standard deviation accepted while zeroing, fraction of full scale
+#define PT_ZERO_MAX_FAILURES 100 // timed out sweeps or invalid readings before zeroing gives up
+#define PT_ZERO_TIMEOUT_MS 3000  // zeroing gives up if it has not collected PT_ZERO_SAMPLES by then
 
 class PressureSensor : ADS131M0x {
 
 private:
-  float slope;
+  float cal[PT_CAL_MAX_DEGREE + 1]; // psi from transducer volts, see PTCalibration.h
+  uint8_t cal_degree;
+  float builtin_slope;
   float last_good_value;
+  float last_volts;
+  bool last_valid = false;
+  bool last_fresh = false;
 
 public:
-  float offset; // public to allow for calibration
-  PressureSensor(int demuxAddr, float slope);
+  float offset;              // public to allow for calibration
+  unsigned long crc_errors = 0; // frames rejected by the crc check since boot
+  unsigned long repeated_samples = 0; // frames read before the ADC had a new conversion since boot
+  char serial[PT_CAL_SERIAL_SIZE] = ""; // transducer the calibration belongs to, empty for the built-in slope
+  PressureSensor(int demuxAddr, float slope); // built-in calibration, psi = slope * volts
+  void setCalibration(const float *coeffs, int degree, const char *serial);
+  void resetCalibration(); // back to the built-in slope
+  const float *getCalibration() { return cal; } // PT_CAL_MAX_DEGREE + 1 coefficients
+  static float polynomial(const float *coeffs, int degree, float volts);
   void begin();
   float getPressure();
-  void zero(float target);
+  float getPressure(const adcOutput &out); // converts a frame read by PTSweep
+  float getLastPressure() { return last_good_value; }
+  float getLastVolts() { return last_volts; }
+  bool getLastValid() { return last_valid; } // false if the latest frame failed its crc and the value is an older one
+  bool getLastFresh() { return last_fresh; } // false if the latest frame repeated the conversion before it
+  float full_scale() { return fabsf(polynomial(cal, cal_degree, 10) - polynomial(cal, cal_degree, 0)); } // psi over 0-10 V
+  using ADS131M0x::getDemuxAddr;
+  using ADS131M0x::getSPIDevice;
+  using ADS131M0x::setOsr;
 };
 
 namespace PT {
 void begin();
 void zero();
+void set_osr(uint16_t osr);      // OSR_* of every PT
+unsigned long crc_error_count(); // total over all PTs
+unsigned long repeated_sample_count();
 extern bool zeroed_since_boot;
 
 extern PressureSensor lox_valve_upstream;
@@ -0,0 +1,140 @@
+#include "Scheduler.h"
+
+#include <Arduino.h>
+
+#include "Router.h"
+
+namespace Scheduler {
+
+namespace {
+struct Task {
+  const char *name;
+  std::function<void()> fn;
+  uint32_t period_us; // 0 for every run()
+  uint32_t next_us;
+  uint32_t budget_us; // 0 for none
+  bool one_shot;
+  bool active;
+  bool running;
+  uint16_t generation; // makes ids of earlier tasks in the same slot stale
+
+  uint32_t runs;
+  uint32_t overruns; // runs longer than budget_us
+  uint32_t max_us;
+  uint64_t total_us;
+};
+
+Task tasks[MAX_TASKS];
+
+Task *find(int id) {
+  if (id < 0) {
+    return nullptr;
+  }
+  Task &t = tasks[id % MAX_TASKS];
+  return t.generation == id / MAX_TASKS ? &t : nullptr;
+}
+
+int add(const char *name, uint32_t delay_us, uint32_t period_us, bool one_shot, std::function<void()> fn, uint32_t budget_us) {
+  for (int i = 0; i < MAX_TASKS; i++) {
+    Task &t = tasks[i];
+    if (t.active || t.running) {
+      continue;
+    }
+    uint16_t generation = t.generation + 1;
+    t = {};
+    t.name = name;
+    t.fn = fn;
+    t.period_us = period_us;
+    t.next_us = micros() + delay_us;
+    t.budget_us = budget_us;
+    t.one_shot = one_shot;
+    t.active = true;
+    t.generation = generation;
+    return generation * MAX_TASKS + i;
+  }
+  Router::info_no_newline("WARNING: no free task slot for ");
+  Router::info(name);
+  return -1;
+}
+
+void run_task(Task &t) {
+  t.running = true;
+  uint32_t start = micros();
+  t.fn();
+  uint32_t elapsed = micros() - start;
+  t.running = false;
+
+  t.runs++;
+  t.total_us += elapsed;
+  t.max_us = max(t.max_us, elapsed);
+  if (t.budget_us > 0 && elapsed > t.budget_us) {
+    t.overruns++;
+  }
+
+  if (t.one_shot) {
+    t.active = false;
+    return;
+  }
+  t.next_us += t.period_us;
+  if ((int32_t)(micros() - t.next_us) >= 0) {
+    t.next_us = micros() + t.period_us; // fell a whole period behind, don't try to catch up
+  }
+}
+} // namespace
+
+void begin() {
+  Router::add({print, "tasks"});
+}
+
+int every(const char *name, uint32_t period_us, std::function<void()> fn, uint32_t budget_us) {
+  return add(name, period_us, period_us, false, fn, budget_us);
+}
+
+int after(const char *name, uint32_t delay_us, std::function<void()> fn, uint32_t budget_us) {
+  return add(name, delay_us, 0, true, fn, budget_us);
+}
+
+void cancel(int id) {
+  Task *t = find(id);
+  if (t) {
+    t->active = false; // the slot stays reserved until a running task returns
+  }
+}
+
+bool pending(int id) {
+  Task *t = find(id);
+  return t && t->active;
+}
+
+void run() {
+  for (int i = 0; i < MAX_TASKS; i++) {
+    Task &t = tasks[i];
+    if (t.active && !t.running && (int32_t)(micros() - t.next_us) >= 0) {
+      run_task(t);
+    }
+  }
+}
+
+void run_until(std::function<bool()> done) {
+  while (!done()) {
+    run();
+    yield();
+  }
+}
+
+void print() {
+  char line[96];
+  Router::info("Task             period(us)     runs  mean(us)   max(us)  budget(us)  overruns");
+  for (int i = 0; i < MAX_TASKS; i++) {
+    const Task &t = tasks[i];
+    if (!t.active) {
+      continue;
+    }
+    snprintf(line, sizeof(line), "%-16s %10lu %8lu %9.1f %9lu %11lu %9lu", t.name, (unsigned long)t.period_us,
+             (unsigned long)t.runs, t.runs ? (double)t.total_us / t.runs : 0.0, (unsigned long)t.max_us,
+             (unsigned long)t.budget_us, (unsigned long)t.overruns);
+    Router::info(line);
+  }
+}
+
+} // namespace Scheduler
@@ -0,0 +1,53 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/*
+ * Scheduler.h
+ *
+ *  Description: Cooperative run-to-completion task scheduler for everything outside the control tick.
+ *  The main loop calls run(), which runs every task that is due once and returns; a task never blocks
+ *  and never yields in the middle. Code that has to wait for something (a command that prompts, PT
+ *  zeroing, an ODrive connecting) calls run_until() instead of spinning, so the other tasks - the
+ *  command line, telemetry, the Zucrow angle readout - keep running meanwhile. A task that is already
+ *  running (the command line while one of its commands waits) is skipped by nested run()s.
+ *
+ *  Every task has a time budget; runs over it are counted, not interrupted. `tasks` prints the
+ *  runtime of every task so a task that hogs the loop shows up. A task's runtime includes whatever ran
+ *  while it waited, so the router's maximum is the longest command.
+ *
+ *  The control tick is not a task, it runs from an IntervalTimer and preempts all of this.
+ */
+
+#include <functional>
+#include <stdint.h>
+
+#define MAX_TASKS 16
+
+namespace Scheduler {
+
+// registers the tasks command
+void begin();
+
+// runs fn every period_us (0: on every run()), first after one period. returns the task id
+int every(const char *name, uint32_t period_us, std::function<void()> fn, uint32_t budget_us = 0);
+
+// runs fn once, delay_us from now. returns the task id
+int after(const char *name, uint32_t delay_us, std::function<void()> fn, uint32_t budget_us = 0);
+
+// stops a task, safe to call from the task itself and with an id that already finished
+void cancel(int id);
+
+// true until a task is cancelled or, for after(), has run
+bool pending(int id);
+
+// runs every task that is due once
+void run();
+
+// runs tasks until done() returns true, checked between tasks
+void run_until(std::function<bool()> done);
+
+void print();
+
+} // namespace Scheduler
+
+#endif
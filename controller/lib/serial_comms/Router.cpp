@@ -8,36 +8,127 @@
 #include "ZucrowInterface.h"
 #include "CString.h"
 #include "SDCard.h"
+#include "Scheduler.h"
 
 #define COMMAND_BUFFER_SIZE (200)
+#define PROMPT_BUFFER_SIZE (2048) // answers to Router::read, long enough for a telemetry channel list
+#define COMMAND_TABLE_SIZE 128    // hashed command slots, must be a power of 2 and more than the commands
 
 namespace Router {
-File comms_log_file;
+LogWriter comms_log_file(COMMS_LOG_BUFFER_SIZE);
 
 CString<COMMAND_BUFFER_SIZE> commandBuffer;
 
 namespace {
 vector<func> funcs;
+uint16_t command_table[COMMAND_TABLE_SIZE]; // index + 1 into funcs, 0 is an empty slot
 
-void readCommand() {
-  // read until newline char or 200 characters (hopefully none of our funcs have names that long lol)
-  COMMS_SERIAL.readBytesUntil('\n', commandBuffer.str, COMMAND_BUFFER_SIZE - 1);
-  commandBuffer.str[COMMAND_BUFFER_SIZE - 1] = '\0'; // null terminate
-  commandBuffer.trim();                              // remove leading/trailing whitespace or newline
+size_t command_length; // bytes of the command line received so far
+char prompt_buffer[PROMPT_BUFFER_SIZE];
+size_t prompt_length;
 
-  comms_log_file.print("<");
-  comms_log_file.print(commandBuffer.str);
-  comms_log_file.print(">\n");
-  comms_log_file.flush();
+const char *args = ""; // rest of the command line after the name, handed out by read()
+
+void log_line(const char *prefix, const char *msg, const char *suffix) {
+  comms_log_file.append(prefix, strlen(prefix));
+  comms_log_file.append(msg, strlen(msg));
+  comms_log_file.append(suffix, strlen(suffix));
+  comms_log_file.service();
+}
+
+// FNV-1a
+uint32_t hash(const char *name) {
+  uint32_t h = 2166136261u;
+  while (*name) {
+    h = (h ^ (uint8_t)*name++) * 16777619u;
+  }
+  return h;
+}
+
+// slot holding name, or the empty slot where it would go
+uint32_t find_slot(const char *name) {
+  uint32_t slot = hash(name) & (COMMAND_TABLE_SIZE - 1);
+  while (command_table[slot] != 0 && strcmp(funcs[command_table[slot] - 1].name, name) != 0) {
+    slot = (slot + 1) & (COMMAND_TABLE_SIZE - 1);
+  }
+  return slot;
+}
+
+// adds whatever has arrived to line without waiting (the serial timeout is 0). true once a newline
+// completes it; a line longer than size is cut off
+bool read_line(char *line, size_t size, size_t &length) {
+  char c;
+  while (COMMS_SERIAL.readBytes(&c, 1) == 1) {
+    if (c == '\n') {
+      line[min(length, size - 1)] = '\0';
+      length = 0;
+      cstring::trim(line); // remove leading/trailing whitespace or carriage return
+      return true;
+    }
+    if (length < size - 1) {
+      line[length] = c;
+    }
+    length++;
+  }
+  return false;
+}
+
+// next space separated inline argument, false once there are none left
+bool next_arg(String &arg) {
+  while (*args == ' ' || *args == '\t') {
+    args++;
+  }
+  if (*args == '\0') {
+    return false;
+  }
+  const char *end = args;
+  while (*end && *end != ' ' && *end != '\t') {
+    end++;
+  }
+  arg = String(args).substring(0, end - args);
+  args = end;
+  return true;
+}
+
+// splits off the inline arguments and calls the command
+void dispatch(char *line) {
+  log_line("<", line, ">\n");
+  if (line[0] == '\0') {
+    return;
+  }
+
+  char *name_end = line;
+  while (*name_end && *name_end != ' ' && *name_end != '\t') {
+    name_end++;
+  }
+  args = name_end;
+  if (*name_end) {
+    *name_end = '\0';
+    args = name_end + 1;
+  }
+
+  uint16_t entry = command_table[find_slot(line)];
+  if (entry == 0) {
+    info("Command not found.");
+  } else {
+    funcs[entry - 1].f(); // call the function. it can decide to send, receive or whatever.
+  }
+
+  String extra;
+  if (next_arg(extra)) {
+    info_no_newline("Ignored extra arguments: ");
+    info(extra + args);
+  }
+  args = "";
 }
 } // namespace
 
 void begin() {
   COMMS_SERIAL.begin(COMMS_RATE);
-  COMMS_SERIAL.setTimeout((unsigned long)-1); // wrap around to max long so we never time out
+  COMMS_SERIAL.setTimeout(0); // reads return what has arrived, waiting is done by polling
 
   if (SDCard::begin()) {
-    comms_log_file = SDCard::open("log.txt", FILE_WRITE);
+    comms_log_file.open("log.txt", 0, true);
   } else {
     Router::info("SD card not found.");
     while (true) {
@@ -49,14 +140,12 @@ void begin() {
 
 void info(const char *msg) {
   COMMS_SERIAL.println(msg);
-  comms_log_file.println(msg);
-  comms_log_file.flush();
+  log_line("", msg, "\r\n");
 }
 
 void info_no_newline(const char *msg) {
   COMMS_SERIAL.print(msg);
-  comms_log_file.print(msg);
-  comms_log_file.flush();
+  log_line("", msg, "");
 }
 
 void send(char msg[], unsigned int len) {
@@ -64,43 +153,70 @@ void send(char msg[], unsigned int len) {
 }
 
 void receive(char msg[], unsigned int len) {
-  COMMS_SERIAL.readBytes(msg, len);
+  unsigned int got = 0;
+  // raw transfers wait for all bytes, with the scheduler (and its watchdog feeding) running meanwhile
+  Scheduler::run_until([&] {
+    got += COMMS_SERIAL.readBytes(msg + got, len - got);
+    return got >= len;
+  });
 }
 
-String read(unsigned int len) {
-  String s = COMMS_SERIAL.readStringUntil('\n', len);
-  s.trim(); // remove leading/trailing whitespace or newline
-
-  comms_log_file.print("<");
-  comms_log_file.print(s);
-  comms_log_file.print(">\n");
-  comms_log_file.flush();
+namespace {
+// waits for the operator's line, truncated to len, and logs it
+String read_line_from_operator(unsigned int len) {
+  comms_log_file.flush(); // waiting on the operator, commit the log to the card
+  Scheduler::run_until([] { return read_line(prompt_buffer, PROMPT_BUFFER_SIZE, prompt_length); });
+  String s = prompt_buffer;
+  if (s.length() > len) {
+    s = s.substring(0, len);
+  }
+  log_line("<", s.c_str(), ">\n");
+  return s;
+}
+} // namespace
 
+String read(unsigned int len) {
+  String s;
+  if (!next_arg(s)) {
+    return read_line_from_operator(len);
+  }
+  COMMS_SERIAL.println(s); // stands in for the operator's echo
+  if (s.length() > len) {
+    s = s.substring(0, len);
+  }
+  log_line("<", s.c_str(), ">\n");
   return s;
 }
 
+String read_typed(unsigned int len) {
+  String extra;
+  if (next_arg(extra)) {
+    info(""); // end the prompt's line
+    info_no_newline("Ignored extra arguments: ");
+    info(extra + args);
+    args = "";
+  }
+  return read_line_from_operator(len);
+}
+
 void add(func f) {
+  uint32_t slot = find_slot(f.name);
+  if (command_table[slot] != 0) {
+    funcs[command_table[slot] - 1] = f; // registered again, the later one wins
+    return;
+  }
+  if (funcs.size() >= COMMAND_TABLE_SIZE - 1) {
+    info("Command table full, raise COMMAND_TABLE_SIZE.");
+    return;
+  }
   funcs.push_back(f);
+  command_table[slot] = funcs.size();
 }
 
-[[noreturn]] void run() { // attribute here enables dead-code warning & compiler optimization
-
-  while (true) {
-    readCommand();
-
-    // commandBuffer.print(); // not needed with echo
-
-    bool cmd_found = false;
-    for (auto &f : funcs) {
-      if (commandBuffer.equals(f.name)) {
-        f.f(); // call the function. it can decide to send, receive or whatever.
-        cmd_found = true;
-        break;
-      }
-    }
-    if (!cmd_found) {
-      info("Command not found.");
-    }
+void poll() {
+  comms_log_file.flush(); // between commands, commit the log to the card
+  if (read_line(commandBuffer.str, COMMAND_BUFFER_SIZE, command_length)) {
+    dispatch(commandBuffer.str);
   }
 }
 
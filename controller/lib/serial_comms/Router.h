@@ -15,15 +15,21 @@
 #include <functional>
 #include <SD.h>
 
+#include "LogWriter.h"
+
 using namespace std;
 
 #define COMMS_SERIAL Serial
 #define COMMS_RATE 9600
+#define COMMS_LOG_BUFFER_SIZE 16384 // bytes of console output buffered for log.txt
 
 struct func;
 
 namespace Router {
 
+// log.txt, everything printed or typed on the console. written back to the card while waiting for input
+extern LogWriter comms_log_file;
+
 // initializes the serial port and configures logs
 void begin();
 
@@ -43,16 +49,21 @@ void send(char msg[], unsigned int len);
 // the caller is responsible for freeing the memory of the message
 void receive(char msg[], unsigned int len);
 
-// reads a message from the serial port into a string and returns it
+// reads a message from the serial port into a string and returns it. takes the next inline argument
+// of the command line instead if there is one (`load_curve_sd THR1.BIN`). scheduler tasks keep
+// running while it waits for the operator
 String read(unsigned int len);
 
-// add registers a new function to the router
+// read() that always waits for the operator, for confirmations. drops (and reports) any inline
+// arguments that are left, so a command line can never answer it
+String read_typed(unsigned int len);
+
+// add registers a new function to the router, looked up by hashing its name
 void add(func f);
 
-// run starts monitoring the serial port for messages and calls the
-// appropriate function when a message is received. this function never
-// returns.
-[[noreturn]] extern void run();
+// reads whatever part of a command line has arrived and runs the command once the line is
+// complete. never waits for input, a scheduler task
+void poll();
 
 // for help function
 void print_all_cmds();
@@ -0,0 +1,105 @@
+#include "SPIBus.h"
+
+#include <Arduino.h>
+
+#include "Router.h"
+#include "SPI_Demux.h"
+
+SPIDevice *SPIDevice::first = nullptr;
+
+namespace SPIBus {
+
+unsigned long conflicts = 0;
+
+namespace {
+SPIDevice *volatile owner = nullptr;
+uint32_t window_start_us = 0;
+} // namespace
+
+void begin() {
+  window_start_us = micros();
+  Router::add({print_stats, "spi_stats"});
+}
+
+bool busy() {
+  return owner != nullptr;
+}
+
+} // namespace SPIBus
+
+// constructed before main, first is zero initialized before any of them
+SPIDevice::SPIDevice(const char *type, int demux_addr, uint32_t clock, uint8_t mode, SPI_Priority priority)
+    : type(type), demux_addr(demux_addr), settings(clock, MSBFIRST, mode), priority(priority) {
+  SPIDevice **tail = &first;
+  while (*tail) {
+    tail = &(*tail)->next;
+  }
+  next = nullptr;
+  *tail = this;
+}
+
+void SPIDevice::begin() {
+  acquire();
+  select();
+}
+
+void SPIDevice::end() {
+  deselect();
+  release();
+}
+
+void SPIDevice::acquire() {
+  if (SPIBus::owner != nullptr) {
+    SPIBus::conflicts++;
+  }
+  SPIBus::owner = this;
+  acquired_us = micros();
+  SPI1.beginTransaction(settings);
+}
+
+void SPIDevice::release() {
+  SPI1.endTransaction();
+  last_transaction_us = micros() - acquired_us;
+  SPIBus::owner = nullptr;
+}
+
+void SPIDevice::select() {
+  SPI_Demux::select_chip(demux_addr);
+  selected_us = micros();
+}
+
+void SPIDevice::deselect() {
+  SPI_Demux::deselect_chip();
+  busy_us = busy_us + (micros() - selected_us);
+  transfers = transfers + 1;
+}
+
+namespace SPIBus {
+
+void print_stats() {
+  uint32_t now = micros();
+  uint32_t window_us = now - window_start_us;
+  window_start_us = now;
+
+  char line[80];
+  Router::info("device  class  transfers   busy us   util %");
+  for (SPIDevice *d = SPIDevice::first; d; d = d->next) {
+    noInterrupts(); // the PT sweep counts from its DMA interrupt
+    uint32_t transfers = d->transfers;
+    uint32_t busy_us = d->busy_us;
+    d->transfers = 0;
+    d->busy_us = 0;
+    interrupts();
+
+    snprintf(line, sizeof(line), "%-4s%3d  %-5s  %9lu  %8lu  %7.3f", d->type, d->demux_addr,
+             d->priority == SPI_PRIORITY_HIGH ? "high" : "low", (unsigned long)transfers, (unsigned long)busy_us,
+             window_us ? 100.0 * busy_us / window_us : 0.0);
+    Router::info(line);
+  }
+  Router::info_no_newline("Over the last ");
+  Router::info_no_newline(window_us / 1000);
+  Router::info_no_newline(" ms, conflicts since boot: ");
+  Router::info(conflicts);
+}
+
+} // namespace SPIBus
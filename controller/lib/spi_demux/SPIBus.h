@@ -0,0 +1,88 @@
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+/*
+ * SPIBus.h
+ *
+ *  Description: Bookkeeping for SPI1. Every chip on the backplane is an SPIDevice that registers its
+ *  demux address, SPI settings and latency class once; drivers go through begin()/end() instead of
+ *  calling SPI1.beginTransaction and SPI_Demux themselves, so the bus knows who holds it and for how
+ *  long. `spi_stats` prints every device's transfers and bus time.
+ *
+ *  SPI1 is only ever used from one context at a time (the control tick and its PT sweep during a
+ *  curve, the scheduler otherwise), so there is nothing to queue - the latency class is the order the
+ *  tick goes to the bus in: PT frames and the Zucrow DAC (SPI_PRIORITY_HIGH) first, then the TC polls
+ *  (SPI_PRIORITY_LOW), then the PT sweep for the next tick. A device that begins while another one
+ *  holds the bus is counted as a conflict, which is always a bug.
+ */
+
+#include <stdint.h>
+
+#include "SPI_Fixed.h"
+
+namespace SPIBus {
+void print_stats();
+}
+
+enum SPI_Priority {
+  SPI_PRIORITY_HIGH, // on every tick, ahead of the valve commands
+  SPI_PRIORITY_LOW,  // polled, may wait until the high priority devices are done
+};
+
+class SPIDevice {
+public:
+  SPIDevice(const char *type, int demux_addr, uint32_t clock, uint8_t mode, SPI_Priority priority);
+
+  // acquire() + select() and deselect() + release(), for a single transfer
+  void begin();
+  void end();
+
+  // takes SPI1 with this device's settings / gives it back
+  void acquire();
+  void release();
+
+  // chip select inside a transaction, for devices that select more than once (DAC channels, the PT
+  // sweep, whose frames all share the first PT's transaction). each select counts as one transfer
+  void select();
+  void deselect();
+
+  int getDemuxAddr() const { return demux_addr; }
+
+  // acquire() to release() of the last transaction in us
+  uint32_t getLastTransactionUs() const { return last_transaction_us; }
+
+private:
+  friend void SPIBus::print_stats();
+
+  const char *type;
+  int demux_addr;
+  SPISettings settings;
+  SPI_Priority priority;
+
+  volatile uint32_t transfers = 0; // chip selects since the last spi_stats
+  volatile uint32_t busy_us = 0;   // time selected since the last spi_stats
+  uint32_t selected_us = 0;
+  uint32_t acquired_us = 0;
+  uint32_t last_transaction_us = 0;
+
+  SPIDevice *next; // every device, in construction order
+  static SPIDevice *first;
+};
+
+namespace SPIBus {
+
+// registers the spi_stats command
+void begin();
+
+// transfers, bus time and utilization of every device since the last call, then starts over
+void print_stats();
+
+// true while a device holds SPI1 (between acquire() and release())
+bool busy();
+
+// devices that began while another one held SPI1, since boot
+extern unsigned long conflicts;
+
+} // namespace SPIBus
+
+#endif
@@ -894,6 +894,26 @@ void SPIClass::dma_rxisr(void) {
     _dma_event_responder->triggerEvent();
   }
 }
+
+void SPIClass::abortTransfer() {
+  if (_dma_state != DMAState::active) {
+    return;
+  }
+  _dmaRX->disable();
+  _dmaTX->disable();
+  _dmaRX->clearInterrupt();
+  _dmaTX->clearComplete();
+  _dmaRX->clearComplete();
+  _dma_count_remaining = 0;
+
+  // same cleanup as the last completion in dma_rxisr, minus the event
+  port().FCR = LPSPI_FCR_TXWATER(15);
+  port().DER = 0;
+  port().CR = LPSPI_CR_MEN | LPSPI_CR_RRF | LPSPI_CR_RTF;
+  port().SR = 0x3f00;
+
+  _dma_state = DMAState::completed;
+}
 #endif // SPI_HAS_TRANSFER_ASYNC
 
 /**********************************************************/
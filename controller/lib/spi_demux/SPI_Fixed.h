@@ -366,6 +366,8 @@ public:
   // Asynch support (DMA )
 #ifdef SPI_HAS_TRANSFER_ASYNC
   bool transfer(const void *txBuffer, void *rxBuffer, size_t count, EventResponderRef event_responder);
+  // stops an async transfer without firing its event, the caller still owns chip select
+  void abortTransfer();
 
   friend void _spi_dma_rxISR0(void);
   inline void dma_rxisr(void);
@@ -499,6 +501,11 @@ private:
   void transfer32(const void *buf, void *retbuf, size_t count);
 };
 
+#elif defined(NATIVE_BUILD)
+
+// workstation build (pio run -e native), see controller/native
+#include <NativeSPI.h>
+
 #endif
 
 extern SPIClass SPI;
@@ -17,12 +17,13 @@ void SPI_Demux::begin() {
   Router::add({deselect_chip_cmd, "spi_deselect"});
 }
 
+// constant pins, so every bit is a single store to the GPIO set or clear register
 void SPI_Demux::select_chip(int chip_id) {
-  digitalWrite(SPI_DEMUX_BIT_0, (bool)(chip_id & 0b00001));
-  digitalWrite(SPI_DEMUX_BIT_1, (bool)(chip_id & 0b00010));
-  digitalWrite(SPI_DEMUX_BIT_2, (bool)(chip_id & 0b00100));
-  digitalWrite(SPI_DEMUX_BIT_3, (bool)(chip_id & 0b01000));
-  digitalWrite(SPI_DEMUX_BIT_4, (bool)(chip_id & 0b10000));
+  digitalWriteFast(SPI_DEMUX_BIT_0, (bool)(chip_id & 0b00001));
+  digitalWriteFast(SPI_DEMUX_BIT_1, (bool)(chip_id & 0b00010));
+  digitalWriteFast(SPI_DEMUX_BIT_2, (bool)(chip_id & 0b00100));
+  digitalWriteFast(SPI_DEMUX_BIT_3, (bool)(chip_id & 0b01000));
+  digitalWriteFast(SPI_DEMUX_BIT_4, (bool)(chip_id & 0b10000));
 }
 
 void SPI_Demux::deselect_chip() {
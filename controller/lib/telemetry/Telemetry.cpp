@@ -0,0 +1,220 @@
+#include "Telemetry.h"
+
+#include <Arduino.h>
+
+#include "Acquisition.h"
+#include "CurveLogger.h"
+#include "CString.h"
+#include "Driver.h"
+#include "Router.h"
+#include "Scheduler.h"
+
+#define FRAME_HEADER_SIZE 7                                                // type, sequence, time
+#define MAX_FRAME_SIZE (FRAME_HEADER_SIZE + TELEMETRY_MAX_CHANNELS * 64 + 2) // a schema of long names is the largest
+#define MAX_ENCODED_SIZE (MAX_FRAME_SIZE + MAX_FRAME_SIZE / 254 + 3)       // COBS overhead and both delimiters
+#define CHANNEL_LIST_LENGTH 2048                                             // every column by name fits
+
+namespace Telemetry {
+
+namespace {
+// keeps the compiler from moving the pending_* accesses across the pending flag (single core), as in LogWriter
+inline void barrier() { __asm__ volatile("" ::: "memory"); }
+
+uint8_t channels[TELEMETRY_MAX_CHANNELS]; // curve log column of each subscribed channel
+unsigned num_channels;
+bool streaming;
+
+// record handed from publish() to service()
+uint32_t pending_values[TELEMETRY_MAX_CHANNELS];
+uint32_t pending_time_us;
+volatile bool pending;
+
+uint16_t sequence;
+uint32_t last_schema_us;
+unsigned long sent;
+unsigned long dropped;
+
+uint8_t frame[MAX_FRAME_SIZE];
+uint8_t encoded[MAX_ENCODED_SIZE];
+
+uint16_t crc16(const uint8_t *data, unsigned len) {
+  uint16_t crc = 0xFFFF;
+  for (unsigned i = 0; i < len; i++) {
+    crc ^= data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// COBS encodes len bytes of in between two delimiters, returns the encoded length
+unsigned cobs_encode(const uint8_t *in, unsigned len, uint8_t *out) {
+  unsigned o = 0;
+  out[o++] = 0;
+  unsigned code_pos = o++;
+  uint8_t code = 1;
+  for (unsigned i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[code_pos] = code;
+      code_pos = o++;
+      code = 1;
+      continue;
+    }
+    out[o++] = in[i];
+    if (++code == 0xFF) {
+      out[code_pos] = code;
+      code_pos = o++;
+      code = 1;
+    }
+  }
+  out[code_pos] = code;
+  out[o++] = 0;
+  return o;
+}
+
+// finishes the frame holding payload_len bytes after the header and writes it if the USB buffer has room
+void send(uint8_t type, uint32_t time_us, unsigned payload_len) {
+  frame[0] = type;
+  memcpy(&frame[1], &sequence, sizeof(sequence));
+  memcpy(&frame[3], &time_us, sizeof(time_us));
+  unsigned len = FRAME_HEADER_SIZE + payload_len;
+  uint16_t crc = crc16(frame, len);
+  memcpy(&frame[len], &crc, sizeof(crc));
+  len += sizeof(crc);
+  sequence++; // counts dropped frames too, so the viewer sees the gap
+
+  unsigned encoded_len = cobs_encode(frame, len, encoded);
+  if ((unsigned)COMMS_SERIAL.availableForWrite() < encoded_len) {
+    dropped++;
+    return;
+  }
+  COMMS_SERIAL.write(encoded, encoded_len);
+  sent++;
+}
+
+void send_schema() {
+  unsigned len = 0;
+  for (unsigned i = 0; i < num_channels; i++) {
+    const char *name = CurveLogger::column_name(channels[i]);
+    frame[FRAME_HEADER_SIZE + len++] = CurveLogger::column_type(channels[i]);
+    memcpy(&frame[FRAME_HEADER_SIZE + len], name, strlen(name) + 1);
+    len += strlen(name) + 1;
+  }
+  last_schema_us = micros();
+  send(TELEMETRY_SCHEMA, last_schema_us, len);
+}
+
+// looks up one comma separated channel name, returns its column or -1
+int find_column(const char *name) {
+  for (unsigned i = 0; i < CurveLogger::num_columns(); i++) {
+    if (strcmp(CurveLogger::column_name(i), name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void subscribe() {
+  Router::info_no_newline("Enter channels (comma separated curve log columns, `all` or `off`): ");
+  String list = Router::read(CHANNEL_LIST_LENGTH);
+
+  if (list == "off") {
+    streaming = false;
+    Router::info_no_newline("Telemetry off, ");
+    Router::info_no_newline(sent);
+    Router::info_no_newline(" frames sent, ");
+    Router::info_no_newline(dropped);
+    Router::info(" dropped.");
+    return;
+  }
+
+  uint8_t selected[TELEMETRY_MAX_CHANNELS];
+  unsigned count = 0;
+  if (list == "all") {
+    for (unsigned i = 0; i < CurveLogger::num_columns() && count < TELEMETRY_MAX_CHANNELS; i++) {
+      selected[count++] = i;
+    }
+  } else {
+    int start = 0;
+    while (start < (int)list.length()) {
+      int end = list.indexOf(',', start);
+      if (end < 0) {
+        end = list.length();
+      }
+      String name = list.substring(start, end);
+      name.trim();
+      int column = find_column(name.c_str());
+      if (column < 0 || count == TELEMETRY_MAX_CHANNELS) {
+        Router::info_no_newline("Unknown channel: ");
+        Router::info(name);
+        return;
+      }
+      selected[count++] = column;
+      start = end + 1;
+    }
+  }
+
+  noInterrupts(); // publish() may be reading the old list
+  memcpy(channels, selected, count);
+  num_channels = count;
+  barrier();
+  pending = false;
+  interrupts();
+  sent = 0;
+  dropped = 0;
+  streaming = count > 0;
+  Router::info_no_newline("Streaming ");
+  Router::info_no_newline(count);
+  Router::info(" channels.");
+  if (streaming) {
+    send_schema();
+  }
+}
+} // namespace
+
+void begin() {
+  Router::add({subscribe, "telemetry"});
+  Scheduler::every("telemetry", TELEMETRY_IDLE_INTERVAL_US, idle, 500);
+}
+
+void publish(const uint32_t *record) {
+  if (!streaming || pending) {
+    return;
+  }
+  for (unsigned i = 0; i < num_channels; i++) {
+    pending_values[i] = record[channels[i]];
+  }
+  pending_time_us = micros();
+  barrier();
+  pending = true;
+}
+
+void service() {
+  if (!streaming) {
+    return;
+  }
+  if (micros() - last_schema_us >= TELEMETRY_SCHEMA_INTERVAL_US) {
+    send_schema();
+  }
+  if (pending) {
+    memcpy(&frame[FRAME_HEADER_SIZE], pending_values, num_channels * sizeof(uint32_t));
+    uint32_t time_us = pending_time_us;
+    barrier();
+    pending = false;
+    send(TELEMETRY_DATA, time_us, num_channels * sizeof(uint32_t));
+  }
+}
+
+void idle() {
+  if (!streaming) {
+    return;
+  }
+  Sensor_Data sd = Acquisition::read();
+  Driver::loxODrive.updateTelemetry();
+  Driver::ipaODrive.updateTelemetry();
+  publish(CurveLogger::pack(CurveLogger::capture_frame(0, 0, -1, false, sd)));
+  service();
+}
+
+} // namespace Telemetry
@@ -0,0 +1,47 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * Telemetry.h
+ *
+ *  Description: Binary live telemetry over the USB serial link, read by telemetry_viewer.py. The
+ *  channels are the curve log columns (CurveLogger), the `telemetry` command picks which of them are
+ *  streamed. While idle a scheduler task samples them every TELEMETRY_IDLE_INTERVAL_US; while a
+ *  curve is armed the control tick publishes its log record and the background sends it, so the tick
+ *  never waits on USB. A frame that doesn't fit in the USB buffer is dropped, not waited for.
+ *
+ *  Frame, little endian: type (1 byte), sequence number (2), micros() (4), payload, CRC-16/CCITT-FALSE
+ *  of everything before it (2). Frames are COBS encoded and written between two 0x00 bytes, so console
+ *  text in between is never mistaken for a frame and a receiver can join at any point.
+ *   - TELEMETRY_DATA payload: one 4 byte value per subscribed channel, in schema order
+ *   - TELEMETRY_SCHEMA payload: per subscribed channel its type character and null terminated name,
+ *     like a curve log schema (CurveLog.h). Sent on subscribing and every TELEMETRY_SCHEMA_INTERVAL_US
+ */
+
+#include <stdint.h>
+
+#define TELEMETRY_DATA 1
+#define TELEMETRY_SCHEMA 2
+
+#define TELEMETRY_MAX_CHANNELS 64
+#define TELEMETRY_IDLE_INTERVAL_US 2000      // 500 Hz while waiting for commands
+#define TELEMETRY_SCHEMA_INTERVAL_US 1000000 // so a viewer started mid-stream learns the channels
+
+namespace Telemetry {
+
+// registers the telemetry command and the idle task
+void begin();
+
+// queues the subscribed channels of a packed curve log record (CurveLogger::pack) for the next service().
+// control tick or main context, skipped while the previous record is still waiting
+void publish(const uint32_t *record);
+
+// sends what publish() queued, background only
+void service();
+
+// samples and sends while no curve runs, a scheduler task every TELEMETRY_IDLE_INTERVAL_US
+void idle();
+
+} // namespace Telemetry
+
+#endif
@@ -42,7 +42,6 @@
 
 #include "SPI_Fixed.h"
 #include <stdlib.h>
-#include "SPI_Demux.h"
 
 /**************************************************************************/
 /*!
@@ -50,8 +49,7 @@
     @param  demuxAddr
 */
 /**************************************************************************/
-Adafruit_MAX31856::Adafruit_MAX31856(int demuxAddr) {
-  this->demuxAddr = demuxAddr;
+Adafruit_MAX31856::Adafruit_MAX31856(int demuxAddr) : spi("tc", demuxAddr, 4000000, SPI_MODE1, SPI_PRIORITY_LOW) {
 }
 
 /**************************************************************************/
@@ -236,6 +234,17 @@ float Adafruit_MAX31856::readThermocoupleTemperature(void) {
     }
   }
 
+  return readLinearizedTemperature();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Return the latest hot-junction temperature without starting or
+    waiting for a conversion
+    @returns Floating point temperature in Celsius
+*/
+/**************************************************************************/
+float Adafruit_MAX31856::readLinearizedTemperature(void) {
   // read the thermocouple temperature registers (3 bytes)
   int32_t temp24 = readRegister24(MAX31856_LTCBH_REG);
   // and compute temperature
@@ -285,8 +294,7 @@ void Adafruit_MAX31856::readRegisterN(uint8_t addr, uint8_t buffer[],
                                       uint8_t n) {
   addr &= 0x7F; // MSB=0 for read, make sure top bit is not set
 
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  spi.begin();
 
   SPI1.transfer(addr);
 
@@ -294,8 +302,7 @@ void Adafruit_MAX31856::readRegisterN(uint8_t addr, uint8_t buffer[],
     buffer[i] = SPI1.transfer(0xFF);
   }
 
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
+  spi.end();
 }
 
 void Adafruit_MAX31856::writeRegister8(uint8_t addr, uint8_t data) {
@@ -303,8 +310,7 @@ void Adafruit_MAX31856::writeRegister8(uint8_t addr, uint8_t data) {
 
   uint8_t buffer[2] = {addr, data};
 
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE1));
-  SPI_Demux::select_chip(demuxAddr);
+  spi.begin();
   delayMicroseconds(2);
 
   for (size_t i = 0; i < 2; i++) {
@@ -312,6 +318,5 @@ void Adafruit_MAX31856::writeRegister8(uint8_t addr, uint8_t data) {
   }
 
   delayMicroseconds(2);
-  SPI_Demux::deselect_chip();
-  SPI1.endTransaction();
+  spi.end();
 }
\ No newline at end of file
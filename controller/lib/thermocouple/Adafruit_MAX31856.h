@@ -99,6 +99,8 @@ typedef enum {
 #include "WProgram.h"
 #endif
 
+#include "SPIBus.h"
+
 /**************************************************************************/
 /*!
     @brief  Class that stores state and functions for interacting with MAX31856
@@ -122,6 +124,7 @@ public:
 
   float readCJTemperature(void);
   float readThermocoupleTemperature(void);
+  float readLinearizedTemperature(void);
 
   void setTempFaultThreshholds(float flow, float fhigh);
   void setColdJunctionFaultThreshholds(int8_t low, int8_t high);
@@ -130,7 +133,7 @@ public:
   void writeRegister8(uint8_t addr, uint8_t reg);
 
 private:
-  int demuxAddr;
+  SPIDevice spi;
   bool initialized = false;
 
   max31856_conversion_mode_t conversionMode;
@@ -1,10 +1,11 @@
 #include "Thermocouples.h"
 #include "SPI_Demux.h"
+#include "Router.h"
 
 Thermocouple::Thermocouple(int demuxAddr) : Adafruit_MAX31856(demuxAddr) {
 }
 
-void Thermocouple::begin(max31856_thermocoupletype_t tc_type) {
+void Thermocouple::begin(max31856_thermocoupletype_t tc_type, max31856_conversion_mode_t mode, uint32_t phase_us) {
   // assert on any fault
   writeRegister8(MAX31856_MASK_REG, 0x0);
 
@@ -17,24 +18,87 @@ void Thermocouple::begin(max31856_thermocoupletype_t tc_type) {
   // set Type K by default
   setThermocoupleType(tc_type);
 
-  // set One-Shot conversion mode
-  setConversionMode(MAX31856_CONTINUOUS);
+  setConversionMode(mode);
+  this->mode = mode;
+  this->phase_us = phase_us;
+  converting = false;
+  next_read_us = micros() + phase_us;
+  next_fault_us = next_read_us + TC_FAULT_POLL_INTERVAL_US / 2;
+}
+
+void Thermocouple::restart() {
+  faults = readFault();
+  if (!converting) {
+    last_kelvin = readLinearizedTemperature() + 273.15;
+    sample_time_us = micros();
+  }
+  next_read_us = micros() + phase_us;
+  next_fault_us = next_read_us + TC_FAULT_POLL_INTERVAL_US / 2;
+  converting = false;
+}
+
+bool Thermocouple::update() {
+  uint32_t now = micros();
+  if ((int32_t)(now - next_read_us) >= 0) {
+    if (mode == MAX31856_ONESHOT && !converting) {
+      triggerOneShot();
+      converting = true;
+      next_read_us = now + TC_ONESHOT_US;
+      return false;
+    }
+    last_kelvin = readLinearizedTemperature() + 273.15;
+    sample_time_us = now;
+    converting = false;
+    next_read_us = now + (mode == MAX31856_ONESHOT ? 0 : TC_CONTINUOUS_INTERVAL_US);
+    return true;
+  }
+  if ((int32_t)(now - next_fault_us) >= 0) {
+    faults = readFault();
+    next_fault_us = now + TC_FAULT_POLL_INTERVAL_US;
+  }
+  return false;
 }
 
 float Thermocouple::getTemperature_F() {
-  return readThermocoupleTemperature() * 9.0 / 5.0 + 32;
+  return (getTemperature_Kelvin() - 273.15) * 9.0 / 5.0 + 32;
 }
 
 float Thermocouple::getTemperature_Kelvin() {
-  return readThermocoupleTemperature() + 273.15;
+  update();
+  return last_kelvin;
 }
 
 namespace TC {
 Thermocouple lox_venturi_temperature(SPI_DEVICE_TC_LOX_VENTURI);
 Thermocouple lox_valve_temperature(SPI_DEVICE_TC_LOX_VALVE);
 
+namespace {
+void print_faults(const char *name, Thermocouple &tc) {
+  uint8_t f = tc.getFaults();
+  Router::info_no_newline(name);
+  if (f == 0) {
+    Router::info("ok");
+    return;
+  }
+  const char *names[] = {"open circuit", "over/under voltage", "tc low", "tc high", "cj low", "cj high", "tc out of range", "cj out of range"};
+  for (int bit = 0; bit < 8; bit++) {
+    if (f & (1 << bit)) {
+      Router::info_no_newline(names[bit]);
+      Router::info_no_newline(" ");
+    }
+  }
+  Router::info(tc.isValid() ? "" : "- INVALID");
+}
+
+void status() {
+  print_faults("LOX valve TC: ", lox_valve_temperature);
+  print_faults("LOX venturi TC: ", lox_venturi_temperature);
+}
+} // namespace
+
 void begin() {
-  lox_venturi_temperature.begin(MAX31856_TCTYPE_E);
-  lox_valve_temperature.begin(MAX31856_TCTYPE_E);
+  lox_venturi_temperature.begin(MAX31856_TCTYPE_E, MAX31856_CONTINUOUS, TC_CONTINUOUS_INTERVAL_US / 2);
+  lox_valve_temperature.begin(MAX31856_TCTYPE_E, MAX31856_CONTINUOUS, TC_CONTINUOUS_INTERVAL_US);
+  Router::add({status, "tc_status"});
 }
-} // namespace TC
\ No newline at end of file
+} // namespace TC
@@ -5,16 +5,48 @@
 
 #include "Adafruit_MAX31856.h"
 
+// MAX31856 conversion times with the 60 Hz filter and no averaging, the DRDY pins aren't wired to the Teensy
+#define TC_CONTINUOUS_INTERVAL_US 100000 // between conversions in continuous mode
+#define TC_ONESHOT_US 155000             // from triggering a one-shot conversion to its result
+#define TC_FAULT_POLL_INTERVAL_US 500000 // fault status register
+
+// faults that make the temperature meaningless: open thermocouple, input over/under voltage, out of range.
+// the high/low threshold faults are left to the window comparators
+#define TC_INVALID_FAULTS (MAX31856_FAULT_OPEN | MAX31856_FAULT_OVUV | MAX31856_FAULT_TCRANGE | MAX31856_FAULT_CJRANGE)
+
 class Thermocouple : Adafruit_MAX31856 {
 
+private:
+  max31856_conversion_mode_t mode;
+  uint32_t phase_us;
+  float last_kelvin = NAN;
+  uint32_t sample_time_us = 0;
+  uint32_t next_read_us = 0;  // when the next conversion is ready
+  uint32_t next_fault_us = 0; // when the fault register is due
+  bool converting = false;    // one-shot triggered, not read yet
+  uint8_t faults = 0;
+
 public:
   Thermocouple(int demuxAddr);
-  void begin(max31856_thermocoupletype_t type);
+  // phase_us delays the first read, so TCs sharing the bus don't come due in the same tick
+  void begin(max31856_thermocoupletype_t type, max31856_conversion_mode_t mode = MAX31856_CONTINUOUS, uint32_t phase_us = 0);
 
-  // get temperature in F
-  float getTemperature_F();
+  // never waits: reads the conversion once it is ready (and triggers the next in one-shot mode), otherwise
+  // reads the fault register once that is due, otherwise doesn't touch the bus. true if a new temperature was read
+  bool update();
 
-  // get temperature in F
+  // blocking read of the latest conversion and the faults, then update() reads again phase_us after it.
+  // for the start of a curve, after a long idle the schedule may be stale
+  void restart();
+
+  // latest values, constant time
+  float getLastKelvin() { return last_kelvin; }
+  uint32_t getSampleTime() { return sample_time_us; } // micros() when the temperature was read
+  uint8_t getFaults() { return faults; }              // MAX31856_FAULT_* from the last fault poll
+  bool isValid() { return !(faults & TC_INVALID_FAULTS) && !isnan(last_kelvin); }
+
+  // update() and the latest temperature, for the console
+  float getTemperature_F();
   float getTemperature_Kelvin();
 };
 
@@ -25,4 +57,4 @@ extern Thermocouple lox_venturi_temperature;
 extern Thermocouple lox_valve_temperature;
 } // namespace TC
 
-#endif // TC_SENSOR_H
\ No newline at end of file
+#endif // TC_SENSOR_H
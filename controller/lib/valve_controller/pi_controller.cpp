@@ -7,8 +7,7 @@ PI_Controller::PI_Controller(float kp, float ki, float max_output) {
   this->max_output = max_output;
 }
 
-float PI_Controller::compute(float input_error, float acc_factor) {
-  long long this_compute_time = millis();
+float PI_Controller::compute(float input_error, float acc_factor, long long this_compute_time) {
   if (this->last_compute_time == -1) {
     this->last_compute_time = this_compute_time; // zeroes out the delta on the first iteration
   }
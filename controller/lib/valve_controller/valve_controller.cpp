@@ -172,8 +172,16 @@ void open_loop_thrust_control(float thrust, Sensor_Data sensor_data, float *angl
   vc_state.ipa_valve_downstream_calc = ipa_valve_downstream_pressure_goal;
 }
 
+// scales down integration while a valve lags its command, 1 when on target, 0 when 8 degrees or more behind
+// INPUT: commanded and measured valve positions (turns)
+float tracking_acc_factor(float pos_cmd, float pos) {
+  float angle_delta = fabs(pos_cmd - pos);
+  return fmax(0, 1 - (angle_delta / (8.0 / 360)));
+}
+
 // get valve angles (degrees) given thrust (lbf) and current sensor data using PID controllers
-void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_acc_factor, float ipa_acc_factor, float *angle_ox, float *angle_ipa) {
+// time_ms is the controllers' time base - curve time when following, log time when replaying
+void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_acc_factor, float ipa_acc_factor, long long time_ms, float *angle_ox, float *angle_ipa) {
   // ol_ for open loop computations
   // err_ for err between ol and sensor
   // col_ for closed loop computation
@@ -184,7 +192,7 @@ void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_
   float ol_chamber_pressure = chamber_pressure(thrust);
   float err_chamber_pressure = sensor_data.chamber_pressure - ol_chamber_pressure;
   float ol_mdot_total = mass_flow_rate(ol_chamber_pressure);
-  float cl_mdot_total = ol_mdot_total - ClosedLoopControllers::Chamber_Pressure_Controller.compute(err_chamber_pressure, 1);
+  float cl_mdot_total = ol_mdot_total - ClosedLoopControllers::Chamber_Pressure_Controller.compute(err_chamber_pressure, 1, time_ms);
 
   float ol_mass_flow_ox;
   float ol_mass_flow_ipa;
@@ -201,8 +209,8 @@ void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_
   float ol_angle_ox = lox_valve_angle(sub_critical_cv(ol_mass_flow_ox, sensor_data.ox.valve_upstream_pressure, ox_valve_downstream_pressure_goal, ox_density_from_temperature(sensor_data.ox.valve_temperature)));
   float ol_angle_ipa = ipa_valve_angle(sub_critical_cv(ol_mass_flow_ipa, sensor_data.ipa.valve_upstream_pressure, ipa_valve_downstream_pressure_goal, ipa_density()));
 
-  *angle_ox = ol_angle_ox - ClosedLoopControllers::LOX_Angle_Controller.compute(err_mass_flow_ox, ox_acc_factor);
-  *angle_ipa = ol_angle_ipa - ClosedLoopControllers::IPA_Angle_Controller.compute(err_mass_flow_ipa, ipa_acc_factor);
+  *angle_ox = ol_angle_ox - ClosedLoopControllers::LOX_Angle_Controller.compute(err_mass_flow_ox, ox_acc_factor, time_ms);
+  *angle_ipa = ol_angle_ipa - ClosedLoopControllers::IPA_Angle_Controller.compute(err_mass_flow_ipa, ipa_acc_factor, time_ms);
 
   vc_state.ol_lox_mdot = ol_mass_flow_ox;
   vc_state.ol_ipa_mdot = ol_mass_flow_ipa;
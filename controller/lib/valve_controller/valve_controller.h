@@ -1,6 +1,8 @@
 #ifndef VALVE_CONTROLLER_H
 #define VALVE_CONTROLLER_H
 
+#include <stdint.h>
+
 /*
  * valve_controller.hpp
  *
@@ -26,6 +28,8 @@ struct Sensor_Data {
   float chamber_pressure; // psi
   Fluid_Line ox;
   Fluid_Line ipa;
+  uint32_t invalid;  // bit 1 << Acquisition_Channel for every value that is an older one repeated, see Acquisition.h
+  uint32_t repeated; // same bits for PTs read again before their ADC finished a new conversion
 };
 
 struct VC_State {
@@ -41,6 +45,7 @@ struct VC_State {
 
 extern VC_State vc_state;
 void open_loop_thrust_control(float thrust, Sensor_Data sensor_data, float *angle_ox, float *angle_ipa);
-void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_acc_factor, float ipa_acc_factor, float *angle_ox, float *angle_ipa);
+void closed_loop_thrust_control(float thrust, Sensor_Data sensor_data, float ox_acc_factor, float ipa_acc_factor, long long time_ms, float *angle_ox, float *angle_ipa);
+float tracking_acc_factor(float pos_cmd, float pos);
 void log_only(Sensor_Data sensor_data);
 #endif
\ No newline at end of file
@@ -6,7 +6,18 @@ WindowComparator::WindowComparator(int wc_id, float min_v, float max_v) {
   this->max_v = max_v;
 }
 
-void WindowComparator::check(float v) {
+void WindowComparator::check(float v, bool valid) {
+  if (!valid) {
+    if (++invalid_ticks > WC_MAX_INVALID_TICKS) {
+      WindowComparators::WC_ERROR.isError = true;
+      WindowComparators::WC_ERROR.causeID = wc_id;
+      WindowComparators::WC_ERROR.causeReason = WC_CAUSE_INVALID;
+      WindowComparators::WC_ERROR.causeValue = invalid_ticks;
+      WindowComparators::WC_ERROR.compValue = WC_MAX_INVALID_TICKS;
+    }
+    return;
+  }
+  invalid_ticks = 0;
   if (v < min_v) {
     WindowComparators::WC_ERROR.isError = true;
     WindowComparators::WC_ERROR.causeID = wc_id;
@@ -25,9 +36,6 @@ void WindowComparator::check(float v) {
 
 namespace WindowComparators {
 wc_error_info WC_ERROR = {.isError = false};
-void reset() {
-  WC_ERROR.isError = false;
-}
 
 WindowComparator lox_valve_upstream_pressure(WC_LOX_VALVE_UPSTREAM_ID, -3000, 3000);
 WindowComparator lox_valve_downstream_pressure(WC_LOX_VALVE_DOWNSTREAM_ID, -3000, 3000);
@@ -41,4 +49,17 @@ WindowComparator ipa_venturi_differential_pressure(WC_IPA_VENTURI_DIFFERENTIAL_I
 
 WindowComparator chamber_pressure(WC_CHAMBER_PRESSURE_ID, -3000, 3000);
 
+WindowComparator *const all[] = {
+    &lox_valve_upstream_pressure, &lox_valve_downstream_pressure, &lox_venturi_differential_pressure,
+    &lox_venturi_temperature, &lox_valve_temperature, &ipa_valve_upstream_pressure,
+    &ipa_valve_downstream_pressure, &ipa_venturi_differential_pressure, &chamber_pressure,
+};
+
+void reset() {
+  WC_ERROR.isError = false;
+  for (WindowComparator *wc : all) {
+    wc->clear();
+  }
+}
+
 } // namespace WindowComparators
@@ -1,14 +1,17 @@
 #ifndef WINDOW_COMPARATOR_H
 #define WINDOW_COMPARATOR_H
 
-#define WC_CAUSE_UNDERFLOW false
-#define WC_CAUSE_OVERFLOW true
+#define WC_CAUSE_UNDERFLOW 0
+#define WC_CAUSE_OVERFLOW 1
+#define WC_CAUSE_INVALID 2 // no valid reading for more than WC_MAX_INVALID_TICKS checks in a row
+
+#define WC_MAX_INVALID_TICKS 10 // a couple of crc errors are tolerated, a dead sensor is not
 
 struct wc_error_info {
   bool isError;     // true if any wc triggers error
   int causeID;      // wc id that caused error
-  bool causeReason; // WC_CAUSE_*
-  float causeValue; // value that caused error
+  int causeReason;  // WC_CAUSE_*
+  float causeValue; // value that caused error, invalid checks in a row for WC_CAUSE_INVALID
   float compValue;  // value that was compared against to cause error
 };
 
@@ -18,10 +21,12 @@ private:
   int wc_id;
   float min_v;
   float max_v;
+  int invalid_ticks = 0;
 
 public:
   WindowComparator(int wc_id, float min_v, float max_v);
-  void check(float v);
+  void check(float v, bool valid = true); // an invalid v is a repeated older value, it is not range checked
+  void clear() { invalid_ticks = 0; }
 };
 
 namespace WindowComparators {
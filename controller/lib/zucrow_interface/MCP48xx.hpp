@@ -2,17 +2,26 @@
 #define MCP48XX_LIB_MCP48XX_H
 
 // modified by @RobertJN64 to support the tadpole multi-device SPI system
+// updateDAC() only writes the channels whose command changed, both in one SPI1 transaction. an unchanged
+// channel is rewritten every MCP48XX_REFRESH_US anyway, so a write the DAC missed does not stick
 
 #include <Arduino.h>
 #include "SPI_Fixed.h"
 #include "SPI_Demux.h"
+#include "SPIBus.h"
+
+#define MCP48XX_CS_SETUP_NS 100  // demux propagation plus the DAC's CS setup/hold, with margin
+#define MCP48XX_REFRESH_US 100000 // longest time a channel goes without a write
 
 template <uint8_t BITS_RES>
 class MCP48xx {
 
 private:
-  int demuxAddr;
+  SPIDevice spi;
   uint16_t command[2] = {0};
+  uint16_t sent[2] = {0}; // last command written to each channel
+  bool sentValid[2] = {false, false};
+  uint32_t sentUs[2] = {0}; // micros() of the last write to each channel
   bool isAActive = false;
   bool isBActive = false;
 
@@ -57,7 +66,17 @@ public:
 
   void setGainB(Gain gain);
 
-  void updateDAC();
+  // writes the changed channels and those due for a refresh, returns false (and leaves SPI1 alone) if none
+  bool updateDAC();
+
+  // SPI1 time of the last write in us
+  uint32_t lastBusUs() const { return spi.getLastTransactionUs(); }
+
+private:
+  bool needsWrite(Channel channel, bool active) const {
+    return active && !(sentValid[channel] && sent[channel] == command[channel] && micros() - sentUs[channel] < MCP48XX_REFRESH_US);
+  }
+  void writeChannel(Channel channel);
 };
 
 typedef MCP48xx<12> MCP4822;
@@ -67,7 +86,7 @@ typedef MCP48xx<8> MCP4802;
 /* Implementation */
 
 template <uint8_t BITS_RES>
-MCP48xx<BITS_RES>::MCP48xx(int demuxAddr) : demuxAddr(demuxAddr) {
+MCP48xx<BITS_RES>::MCP48xx(int demuxAddr) : spi("dac", demuxAddr, 4000000, SPI_MODE0, SPI_PRIORITY_HIGH) {
   /* Setting channel bits*/
   command[Channel::A] = command[Channel::A] | (0u << 15u);
   command[Channel::B] = command[Channel::B] | (1u << 15u);
@@ -154,26 +173,34 @@ void MCP48xx<BITS_RES>::setGainB(Gain gain) {
 }
 
 template <uint8_t BITS_RES>
-void MCP48xx<BITS_RES>::updateDAC() {
+void MCP48xx<BITS_RES>::writeChannel(Channel channel) {
+  spi.select();
+  delayNanoseconds(MCP48XX_CS_SETUP_NS);
+  SPI1.transfer16(command[channel]); // latched by the rising CS (LDAC is tied low)
+  delayNanoseconds(MCP48XX_CS_SETUP_NS);
+  spi.deselect();
+  sent[channel] = command[channel];
+  sentValid[channel] = true;
+  sentUs[channel] = micros();
+}
+
+template <uint8_t BITS_RES>
+bool MCP48xx<BITS_RES>::updateDAC() {
+  bool writeA = needsWrite(Channel::A, isAActive);
+  bool writeB = needsWrite(Channel::B, isBActive);
+  if (!writeA && !writeB) {
+    return false;
+  }
 
-  /* begin transaction using maximum clock frequency of 1MHz */
-  SPI1.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
-  if (isAActive) {
-    SPI_Demux::select_chip(demuxAddr);
-    delayMicroseconds(2);
-    SPI1.transfer16(command[Channel::A]); // sent command for the A channel
-    delayMicroseconds(2);
-    SPI_Demux::deselect_chip();
+  spi.acquire();
+  if (writeA) {
+    writeChannel(Channel::A);
   }
-  delayMicroseconds(5);
-  if (isBActive) {
-    SPI_Demux::select_chip(demuxAddr);
-    delayMicroseconds(2);
-    SPI1.transfer16(command[Channel::B]); // sent command for the B channel
-    delayMicroseconds(2);
-    SPI_Demux::deselect_chip();
+  if (writeB) {
+    writeChannel(Channel::B);
   }
-  SPI1.endTransaction();
+  spi.release();
+  return true;
 }
 
 #endif // MCP48XX_LIB_MCP48XX_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "MCP48xx.hpp"
 #include "Router.h"
 #include "Driver.h"
+#include "Scheduler.h"
 
 MCP4822 dac(SPI_DEVICE_ZUCROW_DAC);
 
@@ -54,7 +55,7 @@ void ZucrowInterface::send_sync_to_zucrow(bool status) {
   digitalWrite(TEENSY_SYNC_PIN, status);
 }
 
-void ZucrowInterface::send_valve_angles_to_zucrow(float lox_pos, float ipa_pos) {
+uint32_t ZucrowInterface::send_valve_angles_to_zucrow(float lox_pos, float ipa_pos) {
   lox_pos = min(0.25, max(0, lox_pos)); // clamp
   ipa_pos = min(0.25, max(0, ipa_pos)); // clamp
 
@@ -62,7 +63,7 @@ void ZucrowInterface::send_valve_angles_to_zucrow(float lox_pos, float ipa_pos)
   int vb = ipa_pos * 4 * 4096;
   dac.setVoltageA(va);
   dac.setVoltageB(vb);
-  dac.updateDAC();
+  return dac.updateDAC() ? dac.lastBusUs() : 0;
 }
 
 void ZucrowInterface::print_zi_status() {
@@ -85,14 +86,18 @@ void ZucrowInterface::zero_angle_outputs() {
   send_valve_angles_to_zucrow(0, 0);
 }
 
-void ZucrowInterface::report_angles_for_five_seconds() {
-  elapsedMillis odrive_monitor_window = elapsedMillis();
-  unsigned long start_time = odrive_monitor_window;
-  while (odrive_monitor_window - start_time < 5000) {
-    delay(1);
-    ZucrowInterface::send_valve_angles_to_zucrow(0.25 - Driver::loxODrive.last_enc_msg.Pos_Estimate,
-                                                 0.25 - Driver::ipaODrive.last_enc_msg.Pos_Estimate);
-    Driver::loxODrive.pumpEvents();
-    Driver::ipaODrive.pumpEvents();
+void ZucrowInterface::report_angles(uint32_t duration_ms) {
+  static int task = -1;
+  static uint32_t end_ms;
+  end_ms = millis() + duration_ms;
+  if (Scheduler::pending(task)) {
+    return; // already reporting, just extend it
   }
+  task = Scheduler::every("zucrow_angles", 1000, [] {
+    ZucrowInterface::send_valve_angles_to_zucrow(0.25 - Driver::loxODrive.last_enc_msg.read().Pos_Estimate,
+                                                 0.25 - Driver::ipaODrive.last_enc_msg.read().Pos_Estimate);
+    if ((int32_t)(millis() - end_ms) >= 0) {
+      Scheduler::cancel(task);
+    }
+  }, 100);
 }
\ No newline at end of file
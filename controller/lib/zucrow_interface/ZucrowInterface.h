@@ -1,6 +1,8 @@
 #ifndef ZUCROW_H
 #define ZUCROW_H
 
+#include <stdint.h>
+
 // INPUTS FROM ZUCROW
 #define ZUCROW_PANIC false
 #define ZUCROW_NO_PANIC true
@@ -35,8 +37,10 @@ void send_ok_to_zucrow();
 // send TEENSY_SYNC_RUNNING or TEENSY_SYNC_IDLE to zucrow
 void send_sync_to_zucrow(bool status);
 
-// send valve angle telemetry to zucrow, pos should be from 0 to 0.25 for 0 to 90 deg
-void send_valve_angles_to_zucrow(float lox_pos, float ipa_pos);
+// send valve angle telemetry to zucrow, pos should be from 0 to 0.25 for 0 to 90 deg. only channels
+// whose 12 bit code changed (or are due for the MCP48XX_REFRESH_US rewrite) go out on SPI1. returns the
+// SPI1 time of the update in us, 0 if nothing was written
+uint32_t send_valve_angles_to_zucrow(float lox_pos, float ipa_pos);
 
 // for debug
 void print_zi_status();
@@ -44,8 +48,9 @@ void print_zi_status();
 // for AI calib
 void zero_angle_outputs();
 
-// for manual movements
-void report_angles_for_five_seconds();
+// for manual movements, sends the valve angles every millisecond for duration_ms from a scheduler
+// task and returns right away
+void report_angles(uint32_t duration_ms = 5000);
 
 } // namespace ZucrowInterface
 
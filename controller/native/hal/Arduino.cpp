@@ -0,0 +1,298 @@
+#include "Arduino.h"
+#include "Plant.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+volatile uint32_t ARM_DEMCR;
+volatile uint32_t ARM_DWT_CTRL;
+
+// ---- timing ----
+
+// every clock read costs a microsecond of virtual time so polling loops always make progress
+uint32_t micros() {
+  Sim::advance(1);
+  return (uint32_t)Sim::now_us();
+}
+
+uint32_t millis() {
+  Sim::advance(1);
+  return (uint32_t)(Sim::now_us() / 1000);
+}
+
+// follows the virtual clock, each read costs a few cycles so back to back reads still differ
+uint32_t sim_cycle_count() {
+  static uint64_t cycles = 0;
+  cycles = std::max<uint64_t>(cycles + 7, Sim::now_us() * (F_CPU_ACTUAL / 1000000));
+  return (uint32_t)cycles;
+}
+
+void delay(uint32_t ms) {
+  Sim::advance(ms * 1000);
+  yield();
+}
+
+void delayMicroseconds(uint32_t us) {
+  Sim::advance(us);
+}
+
+void yield() {
+  EventResponder::runFromYield();
+  Sim::idle(false);
+}
+
+// ---- watchdog ----
+volatile uint16_t WDOG1_WCR = WDOG_WCR_WDA | WDOG_WCR_SRS;
+Sim_WDOG_WSR WDOG1_WSR;
+volatile uint16_t WDOG1_WICR = WDOG_WICR_WICT(4);
+volatile uint16_t WDOG1_WMCR = 1;
+
+namespace {
+void (*wdog1_isr)(void) = nullptr;
+uint16_t wdog1_last_service = 0;
+int wdog1_interrupt_timer = -1;
+int wdog1_reset_timer = -1;
+} // namespace
+
+void attachInterruptVector(int irq, void (*function)(void)) {
+  if (irq == IRQ_WDOG1) {
+    wdog1_isr = function;
+  }
+}
+
+void Sim_WDOG_WSR::operator=(uint16_t value) {
+  bool service = wdog1_last_service == 0x5555 && value == 0xAAAA;
+  wdog1_last_service = value;
+  if (!service || !(WDOG1_WCR & WDOG_WCR_WDE)) {
+    return;
+  }
+  Sim::cancel(wdog1_interrupt_timer);
+  Sim::cancel(wdog1_reset_timer);
+  uint32_t timeout_us = ((WDOG1_WCR >> 8) + 1) * 500000;
+  uint32_t before_us = (WDOG1_WICR & 0xFF) * 500000;
+  if ((WDOG1_WICR & WDOG_WICR_WIE) && before_us < timeout_us) {
+    wdog1_interrupt_timer = Sim::add_timer(timeout_us - before_us, 0, []() {
+      wdog1_interrupt_timer = -1; // the handle is free for reuse once the timer fired
+      WDOG1_WICR = WDOG1_WICR | WDOG_WICR_WTIS;
+      if (wdog1_isr) {
+        wdog1_isr();
+      }
+    });
+  }
+  wdog1_reset_timer = Sim::add_timer(timeout_us, 0, []() {
+    fprintf(stderr, "WDOG1 timed out, resetting\n");
+    exit(3);
+  });
+}
+
+// ---- gpio ----
+namespace {
+uint8_t pin_values[64];
+void (*pin_isr[64])(void);
+int pin_isr_mode[64];
+} // namespace
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP && pin < 64) {
+    pin_values[pin] = HIGH;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < 64) {
+    pin_values[pin] = val ? HIGH : LOW;
+    Plant::pin_written(pin, pin_values[pin]);
+  }
+}
+
+uint8_t digitalRead(uint8_t pin) {
+  if (pin >= 64) {
+    return LOW;
+  }
+  uint8_t val;
+  if (Plant::pin_input(pin, &val)) {
+    pin_values[pin] = val;
+  }
+  return pin_values[pin];
+}
+
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode) {
+  if (pin < 64) {
+    pin_isr[pin] = function;
+    pin_isr_mode[pin] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 64) {
+    pin_isr[pin] = nullptr;
+  }
+}
+
+void sim_drive_pin(uint8_t pin, uint8_t val) {
+  if (pin >= 64) {
+    return;
+  }
+  uint8_t old = pin_values[pin];
+  pin_values[pin] = val ? HIGH : LOW;
+  if (pin_isr[pin] == nullptr || old == pin_values[pin]) {
+    return;
+  }
+  int mode = pin_isr_mode[pin];
+  if (mode == CHANGE || (mode == RISING && pin_values[pin]) || (mode == FALLING && !pin_values[pin])) {
+    Sim::run_isr(pin_isr[pin]);
+  }
+}
+
+// ---- EventResponder ----
+EventResponder *EventResponder::firstYield = nullptr;
+
+void EventResponder::triggerEvent(int status, void *data) {
+  _status = status;
+  _data = data;
+  _triggered = true;
+  if (_function == nullptr) {
+    return;
+  }
+  if (_type == Immediate) {
+    _function(*this);
+  } else if (!_pending) {
+    _pending = true;
+    _next = firstYield;
+    firstYield = this;
+  }
+}
+
+void EventResponder::runFromYield() {
+  while (firstYield) {
+    EventResponder *er = firstYield;
+    firstYield = er->_next;
+    er->_pending = false;
+    if (er->_function) {
+      er->_function(*er);
+    }
+  }
+}
+
+// ---- IntervalTimer ----
+bool IntervalTimer::begin(void (*funct)(), unsigned int microseconds) {
+  end();
+  if (microseconds == 0) {
+    return false;
+  }
+  this->funct = funct;
+  handle = Sim::add_timer(microseconds, microseconds, funct);
+  return true;
+}
+
+void IntervalTimer::update(unsigned int microseconds) {
+  if (handle >= 0) {
+    begin(funct, microseconds);
+  }
+}
+
+void IntervalTimer::end() {
+  Sim::cancel(handle);
+  handle = -1;
+}
+
+// ---- Serial ----
+usb_serial_class Serial;
+
+namespace {
+int serial_in_fd = -1;
+int serial_out_fd = -1;
+bool serial_eof = false;
+int serial_peek = -1;
+
+// opens a pty pair and keeps the slave side open so reads do not fail while no client is attached
+void open_pty() {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("pty");
+    exit(1);
+  }
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  fcntl(master, F_SETFL, O_NONBLOCK);
+  fprintf(stderr, "Serial port: %s\n", ptsname(master));
+  serial_in_fd = master;
+  serial_out_fd = master;
+}
+} // namespace
+
+void usb_serial_class::begin(long) {
+  if (serial_in_fd >= 0) {
+    return;
+  }
+  if (Sim::options.stdio) {
+    serial_in_fd = STDIN_FILENO;
+    serial_out_fd = STDOUT_FILENO;
+  } else {
+    open_pty();
+  }
+}
+
+// keeps one byte of look-ahead so available() can tell a closed stdin from an idle one
+int usb_serial_class::available() {
+  if (serial_peek >= 0) {
+    return 1;
+  }
+  if (serial_in_fd < 0 || serial_eof) {
+    return 0;
+  }
+  struct pollfd pfd = {serial_in_fd, POLLIN, 0};
+  if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & (POLLIN | POLLHUP))) {
+    return 0;
+  }
+  uint8_t c;
+  if (::read(serial_in_fd, &c, 1) != 1) {
+    serial_eof = true;
+    return 0;
+  }
+  serial_peek = c;
+  return 1;
+}
+
+int usb_serial_class::peek() {
+  return available() ? serial_peek : -1;
+}
+
+int usb_serial_class::read() {
+  if (!available()) {
+    return -1;
+  }
+  int c = serial_peek;
+  serial_peek = -1;
+  return c;
+}
+
+// like Stream::timedRead, but a closed stdin ends the program instead of blocking forever
+int usb_serial_class::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    if (serial_eof) {
+      fflush(stdout);
+      exit(0); // the scripted session is over
+    }
+    Sim::idle(true);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t usb_serial_class::write(const uint8_t *buffer, size_t size) {
+  if (serial_out_fd < 0) {
+    return 0;
+  }
+  ssize_t n = ::write(serial_out_fd, buffer, size); // a full pty buffer drops output, like a closed USB port
+  return n > 0 ? n : 0;
+}
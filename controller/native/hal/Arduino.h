@@ -0,0 +1,180 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+/*
+ * Arduino.h
+ *
+ *  Description: Minimal Teensy 4.1 core stand-in for the native build. Timing functions run on the
+ *  virtual clock in Sim.h, GPIO is a pin array shared with the plant model, and Serial is a pty.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cstdio>
+#include <type_traits>
+
+#include "Sim.h"
+#include "WString.h"
+#include "Stream.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+
+#define RISING 2
+#define FALLING 3
+#define CHANGE 4
+
+#define F_CPU 600000000
+#define F_CPU_ACTUAL 600000000
+
+#define EXTMEM
+#define DMAMEM
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+
+#define NVIC_SET_PRIORITY(irqnum, priority)
+#define NVIC_ENABLE_IRQ(irqnum)
+
+// ---- timing ----
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void delayNanoseconds(uint32_t ns) { Sim::advance(ns / 1000); }
+void yield();
+
+// the DWT cycle counter runs at F_CPU_ACTUAL on the virtual clock
+uint32_t sim_cycle_count();
+extern volatile uint32_t ARM_DEMCR;
+extern volatile uint32_t ARM_DWT_CTRL;
+#define ARM_DWT_CYCCNT (sim_cycle_count())
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL_CYCCNTENA (1 << 0)
+
+class elapsedMillis {
+public:
+  elapsedMillis() : ms(millis()) {}
+  elapsedMillis(unsigned long val) : ms(millis() - val) {}
+  operator unsigned long() const { return millis() - ms; }
+  elapsedMillis &operator=(unsigned long val) {
+    ms = millis() - val;
+    return *this;
+  }
+
+private:
+  unsigned long ms;
+};
+
+class elapsedMicros {
+public:
+  elapsedMicros() : us(micros()) {}
+  elapsedMicros(unsigned long val) : us(micros() - val) {}
+  operator unsigned long() const { return micros() - us; }
+  elapsedMicros &operator=(unsigned long val) {
+    us = micros() - val;
+    return *this;
+  }
+
+private:
+  unsigned long us;
+};
+
+// ---- interrupts ----
+#define noInterrupts() Sim::irq_disable()
+#define interrupts() Sim::irq_enable()
+#define __disable_irq() Sim::irq_disable()
+#define __enable_irq() Sim::irq_enable()
+
+// ---- gpio ----
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint8_t digitalRead(uint8_t pin);
+#define digitalWriteFast(pin, val) digitalWrite(pin, val)
+#define digitalReadFast(pin) digitalRead(pin)
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+// ---- watchdog ----
+// WDOG1 on the virtual clock. it starts counting at the first service sequence after WDE is set, the
+// pre-timeout interrupt (WICR) fires like any other ISR and the reset ends the program
+#define IRQ_WDOG1 92
+#define WDOG_WCR_WT(n) ((uint16_t)(((n) & 0xFF) << 8))
+#define WDOG_WCR_WDA ((uint16_t)(1 << 5))
+#define WDOG_WCR_SRS ((uint16_t)(1 << 4))
+#define WDOG_WCR_WDE ((uint16_t)(1 << 2))
+#define WDOG_WICR_WIE ((uint16_t)(1 << 15))
+#define WDOG_WICR_WTIS ((uint16_t)(1 << 14))
+#define WDOG_WICR_WICT(n) ((uint16_t)((n) & 0xFF))
+
+// the service register, writing 0x5555 then 0xAAAA reloads the counter
+struct Sim_WDOG_WSR {
+  void operator=(uint16_t value);
+};
+extern volatile uint16_t WDOG1_WCR;
+extern Sim_WDOG_WSR WDOG1_WSR;
+extern volatile uint16_t WDOG1_WICR;
+extern volatile uint16_t WDOG1_WMCR;
+void attachInterruptVector(int irq, void (*function)(void));
+
+// ---- memory ----
+inline void *extmem_malloc(size_t size) { return malloc(size); }
+inline void *extmem_calloc(size_t nmemb, size_t size) { return calloc(nmemb, size); }
+inline void *extmem_realloc(void *ptr, size_t size) { return realloc(ptr, size); }
+inline void extmem_free(void *ptr) { free(ptr); }
+inline void arm_dcache_flush(void *, uint32_t) {} // no cache, and the WDOG1 reset ends the program anyway
+
+// ---- math helpers, matching the mixed-type templates in the Teensy core ----
+template <class A, class B>
+constexpr typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <class A, class B>
+constexpr typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <class T, class L, class H>
+constexpr typename std::common_type<T, L, H>::type constrain(T x, L low, H high) { return x < low ? low : (x > high ? high : x); }
+
+template <class T, class A, class B, class C, class D>
+long map(T x, A in_min, B in_max, C out_min, D out_max, typename std::enable_if<std::is_integral<T>::value>::type * = 0) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+template <class T, class A, class B, class C, class D>
+T map(T x, A in_min, B in_max, C out_min, D out_max, typename std::enable_if<std::is_floating_point<T>::value>::type * = 0) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ---- serial ----
+class usb_serial_class : public Stream {
+public:
+  void begin(long baud);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return 4096; }
+  void flush() override {}
+  operator bool() { return true; }
+
+protected:
+  int timedRead() override;
+};
+extern usb_serial_class Serial;
+
+#include "EventResponder.h"
+#include "IntervalTimer.h"
+
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,52 @@
+#include "EEPROM.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Sim.h"
+
+EEPROMClass EEPROM;
+
+namespace {
+uint8_t image[E2END + 1];
+bool loaded = false;
+
+// erased flash reads 0xFF, a missing file is a blank EEPROM
+void load() {
+  memset(image, 0xFF, sizeof(image));
+  loaded = true;
+  if (Sim::options.eeprom_file == nullptr) {
+    return;
+  }
+  FILE *f = fopen(Sim::options.eeprom_file, "rb");
+  if (f) {
+    fread(image, 1, sizeof(image), f);
+    fclose(f);
+  }
+}
+} // namespace
+
+uint8_t EEPROMClass::read(int idx) {
+  if (!loaded) {
+    load();
+  }
+  return idx >= 0 && idx <= E2END ? image[idx] : 0;
+}
+
+void EEPROMClass::write(int idx, uint8_t val) {
+  if (!loaded) {
+    load();
+  }
+  if (idx < 0 || idx > E2END || image[idx] == val) {
+    return;
+  }
+  image[idx] = val;
+  if (Sim::options.eeprom_file == nullptr) {
+    return;
+  }
+  FILE *f = fopen(Sim::options.eeprom_file, "wb"); // written through, the watchdog reset exits right after
+  if (f) {
+    fwrite(image, 1, sizeof(image), f);
+    fclose(f);
+  }
+}
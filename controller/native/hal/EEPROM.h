@@ -0,0 +1,38 @@
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+// EEPROM stand-in, backed by the --eeprom file (kept across runs) or by memory only without one
+
+#include <stdint.h>
+
+#define E2END 0x10BB // last address, 4284 bytes like the Teensy 4.1 emulation
+
+class EEPROMClass {
+public:
+  uint8_t read(int idx);
+  void write(int idx, uint8_t val);
+  void update(int idx, uint8_t val) { write(idx, val); }
+  uint16_t length() { return E2END + 1; }
+
+  template <typename T>
+  T &get(int idx, T &t) {
+    uint8_t *p = (uint8_t *)&t;
+    for (unsigned i = 0; i < sizeof(T); i++) {
+      p[i] = read(idx + i);
+    }
+    return t;
+  }
+
+  template <typename T>
+  const T &put(int idx, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for (unsigned i = 0; i < sizeof(T); i++) {
+      write(idx + i, p[i]);
+    }
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
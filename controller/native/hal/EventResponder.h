@@ -0,0 +1,53 @@
+#ifndef NATIVE_EVENT_RESPONDER_H
+#define NATIVE_EVENT_RESPONDER_H
+
+// EventResponder stand-in: immediate and interrupt handlers run inline, yield handlers run from yield()
+
+class EventResponder;
+typedef EventResponder &EventResponderRef;
+typedef void (*EventResponderFunction)(EventResponderRef);
+
+class EventResponder {
+public:
+  void attach(EventResponderFunction function) {
+    _function = function;
+    _type = Yield;
+  }
+  void attachImmediate(EventResponderFunction function) {
+    _function = function;
+    _type = Immediate;
+  }
+  void attachInterrupt(EventResponderFunction function) {
+    _function = function;
+    _type = Immediate;
+  }
+  void detach() { _function = nullptr; }
+
+  void triggerEvent(int status = 0, void *data = nullptr);
+  void clearEvent() { _triggered = false; }
+  int getStatus() { return _status; }
+  void setStatus(int status) { _status = status; }
+  void *getData() { return _data; }
+  void setContext(void *context) { _context = context; }
+  void *getContext() { return _context; }
+  operator bool() { return _triggered; }
+
+  // runs pending yield-context handlers, called by yield()
+  static void runFromYield();
+
+private:
+  enum Type { Yield,
+              Immediate };
+  EventResponderFunction _function = nullptr;
+  Type _type = Yield;
+  int _status = 0;
+  void *_data = nullptr;
+  void *_context = nullptr;
+  bool _triggered = false;
+  bool _pending = false;
+  EventResponder *_next = nullptr;
+
+  static EventResponder *firstYield;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "FlexCAN_T4.h"
+#include "Arduino.h"
+#include "Plant.h"
+
+namespace {
+NativeFlexCAN *bus = nullptr;
+}
+
+void NativeFlexCAN::begin() {
+  bus = this;
+}
+
+int NativeFlexCAN::write(const CAN_message_t &msg) {
+  Plant::can_write(msg.id | (msg.flags.extended ? 0x80000000 : 0), msg.flags.remote, msg.len, msg.buf);
+  return 1;
+}
+
+bool NativeFlexCAN::setMB(const FLEXCAN_MAILBOX &mb_num, const FLEXCAN_RXTX &mb_rx_tx, const FLEXCAN_IDE &) {
+  mb_tx[mb_num] = mb_rx_tx == TX;
+  return true;
+}
+
+int NativeFlexCAN::write(FLEXCAN_MAILBOX mb_num, const CAN_message_t &msg) {
+  if (!mb_tx[mb_num]) {
+    return 0; // not a transmit mailbox
+  }
+  return write(msg);
+}
+
+void NativeFlexCAN::receive(const CAN_message_t &msg) {
+  if (!events_used) {
+    if (handler) {
+      handler(msg);
+    }
+    return;
+  }
+  int next = (head + 1) % QUEUE_SIZE;
+  if (next == tail) {
+    return; // queue full, frame lost
+  }
+  queue[head] = msg;
+  head = next;
+}
+
+int NativeFlexCAN::read(CAN_message_t &msg) {
+  if (head == tail) {
+    return 0;
+  }
+  msg = queue[tail];
+  tail = (tail + 1) % QUEUE_SIZE;
+  return 1;
+}
+
+uint64_t NativeFlexCAN::events() {
+  events_used = true;
+  CAN_message_t msg;
+  while (true) {
+    noInterrupts();
+    int got = read(msg);
+    interrupts();
+    if (!got) {
+      break;
+    }
+    if (handler) {
+      handler(msg);
+    }
+  }
+  return 0;
+}
+
+void sim_can_receive(uint32_t id, uint8_t len, const uint8_t *buf) {
+  if (bus == nullptr) {
+    return;
+  }
+  CAN_message_t msg;
+  msg.id = id & 0x1FFFFFFF;
+  msg.flags.extended = id & 0x80000000;
+  msg.len = len;
+  memcpy(msg.buf, buf, len);
+  msg.timestamp = (uint16_t)Sim::now_us();
+  Sim::run_isr([&]() { bus->receive(msg); });
+}
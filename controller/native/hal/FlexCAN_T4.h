@@ -0,0 +1,123 @@
+#ifndef NATIVE_FLEXCAN_T4_H
+#define NATIVE_FLEXCAN_T4_H
+
+/*
+ * FlexCAN_T4.h
+ *
+ *  Description: FlexCAN_T4 stand-in for the native build. Frames written by the firmware go to the
+ *  plant model, frames from the plant are dispatched like the real library: straight from the
+ *  receive interrupt until events() has been called once, and from events() after that.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct CAN_message_t {
+  uint32_t id = 0;        // can identifier
+  uint16_t timestamp = 0; // FlexCAN time when message arrived
+  uint8_t idhit = 0;      // filter that id came from
+  struct {
+    bool extended = 0; // identifier is extended (29-bit)
+    bool remote = 0;   // remote transmission request packet type
+    bool overrun = 0;  // message overrun
+    bool reserved = 0;
+  } flags;
+  uint8_t len = 8;      // length of data
+  uint8_t buf[8] = {0}; // data
+  int8_t mb = 0;        // used to identify mailbox reception
+  uint8_t bus = 0;      // used to identify where the message came from when events() is used.
+  bool seq = 0;         // sequential frames
+} CAN_message_t;
+
+typedef void (*_MB_ptr)(const CAN_message_t &msg);
+
+typedef enum FLEXCAN_MAILBOX {
+  MB0, MB1, MB2, MB3, MB4, MB5, MB6, MB7, MB8, MB9, MB10, MB11, MB12, MB13, MB14, MB15
+} FLEXCAN_MAILBOX;
+
+typedef enum FLEXCAN_RXTX {
+  TX,
+  RX,
+  LISTEN_ONLY
+} FLEXCAN_RXTX;
+
+typedef enum FLEXCAN_IDE {
+  NONE = 0,
+  EXT = 1,
+  RTR = 2,
+  STD = 3,
+  INACTIVE
+} FLEXCAN_IDE;
+
+typedef enum CAN_DEV_TABLE {
+  CAN1 = 0x401D0000,
+  CAN2 = 0x401D4000,
+  CAN3 = 0x401D8000
+} CAN_DEV_TABLE;
+
+typedef enum FLEXCAN_RXQUEUE_TABLE {
+  RX_SIZE_2 = (uint16_t)2,
+  RX_SIZE_4 = (uint16_t)4,
+  RX_SIZE_8 = (uint16_t)8,
+  RX_SIZE_16 = (uint16_t)16,
+  RX_SIZE_32 = (uint16_t)32,
+  RX_SIZE_64 = (uint16_t)64,
+  RX_SIZE_128 = (uint16_t)128,
+  RX_SIZE_256 = (uint16_t)256,
+  RX_SIZE_512 = (uint16_t)512,
+  RX_SIZE_1024 = (uint16_t)1024
+} FLEXCAN_RXQUEUE_TABLE;
+
+typedef enum FLEXCAN_TXQUEUE_TABLE {
+  TX_SIZE_2 = (uint16_t)2,
+  TX_SIZE_4 = (uint16_t)4,
+  TX_SIZE_8 = (uint16_t)8,
+  TX_SIZE_16 = (uint16_t)16,
+  TX_SIZE_32 = (uint16_t)32,
+  TX_SIZE_64 = (uint16_t)64,
+  TX_SIZE_128 = (uint16_t)128,
+  TX_SIZE_256 = (uint16_t)256,
+  TX_SIZE_512 = (uint16_t)512,
+  TX_SIZE_1024 = (uint16_t)1024
+} FLEXCAN_TXQUEUE_TABLE;
+
+class FlexCAN_T4_Base {
+public:
+  virtual ~FlexCAN_T4_Base() {}
+  virtual uint64_t events() = 0;
+  virtual int write(const CAN_message_t &msg) = 0;
+};
+
+// one controller is enough for the firmware, so the template parameters are only kept for the signature
+class NativeFlexCAN : public FlexCAN_T4_Base {
+public:
+  void begin();
+  void setBaudRate(uint32_t baud) { baudrate = baud; }
+  void enableMBInterrupts() {}
+  void onReceive(_MB_ptr handler) { this->handler = handler; }
+  uint64_t events() override;
+  int write(const CAN_message_t &msg) override;
+  // like the library, a mailbox only transmits once setMB() made it a TX mailbox
+  bool setMB(const FLEXCAN_MAILBOX &mb_num, const FLEXCAN_RXTX &mb_rx_tx, const FLEXCAN_IDE &ide = STD);
+  int write(FLEXCAN_MAILBOX mb_num, const CAN_message_t &msg);
+  int read(CAN_message_t &msg);
+
+  // called by the plant in "interrupt" context
+  void receive(const CAN_message_t &msg);
+
+private:
+  static const int QUEUE_SIZE = 256;
+  CAN_message_t queue[QUEUE_SIZE];
+  volatile int head = 0;
+  volatile int tail = 0;
+  bool events_used = false;
+  bool mb_tx[16] = {};
+  uint32_t baudrate = 500000;
+  _MB_ptr handler = nullptr;
+};
+
+template <CAN_DEV_TABLE _bus, FLEXCAN_RXQUEUE_TABLE _rxSize = RX_SIZE_16, FLEXCAN_TXQUEUE_TABLE _txSize = TX_SIZE_16>
+class FlexCAN_T4 : public NativeFlexCAN {
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef NATIVE_INTERVAL_TIMER_H
+#define NATIVE_INTERVAL_TIMER_H
+
+// IntervalTimer stand-in, callbacks fire from the virtual clock in interrupt context
+
+#include <stdint.h>
+
+class IntervalTimer {
+public:
+  ~IntervalTimer() { end(); }
+  bool begin(void (*funct)(), unsigned int microseconds);
+  bool begin(void (*funct)(), int microseconds) { return begin(funct, (unsigned int)microseconds); }
+  bool begin(void (*funct)(), unsigned long microseconds) { return begin(funct, (unsigned int)microseconds); }
+  bool begin(void (*funct)(), float microseconds) { return begin(funct, (unsigned int)microseconds); }
+  void update(unsigned int microseconds);
+  void end();
+  void priority(uint8_t n) { nvic_priority = n; }
+  operator bool() { return handle >= 0; }
+
+private:
+  void (*funct)() = nullptr;
+  int handle = -1;
+  uint8_t nvic_priority = 128;
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * NativeMain.cpp
+ *
+ *  Description: Entry point for the native build. Parses the command line, starts the plant model
+ *  and then runs setup() and loop() like the Teensy core does.
+ *
+ *  usage: program [--stdio] [--sd DIR] [--zucrow-abort-ms N] [--can-dropout-ms N] [--eeprom FILE]
+ */
+
+#include "Arduino.h"
+#include "Plant.h"
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--stdio] [--sd DIR] [--zucrow-abort-ms N] [--can-dropout-ms N] [--eeprom FILE]\n", name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--stdio") == 0) {
+      Sim::options.stdio = true;
+    } else if (strcmp(argv[i], "--sd") == 0 && i + 1 < argc) {
+      Sim::options.sd_dir = argv[++i];
+    } else if (strcmp(argv[i], "--zucrow-abort-ms") == 0 && i + 1 < argc) {
+      Sim::options.zucrow_abort_ms = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--can-dropout-ms") == 0 && i + 1 < argc) {
+      Sim::options.can_dropout_ms = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--eeprom") == 0 && i + 1 < argc) {
+      Sim::options.eeprom_file = argv[++i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  Plant::begin();
+  setup();
+  while (true) {
+    loop();
+    yield();
+  }
+}
@@ -0,0 +1,83 @@
+#include "NativeSPI.h"
+#include "Plant.h"
+
+SPIClass SPI;
+SPIClass SPI1;
+SPIClass SPI2;
+
+void SPIClass::beginTransaction(SPISettings settings) {
+  in_transaction = true;
+  byte_time_ns = 8 * 1000000000ull / settings._clock;
+}
+
+// exchanges one byte and charges its bus time, rounded to whole microseconds
+uint8_t SPIClass::exchange(uint8_t out) {
+  uint8_t in = Plant::spi_transfer(out);
+  pending_ns += byte_time_ns;
+  if (pending_ns >= 1000) {
+    delayMicroseconds(pending_ns / 1000);
+    pending_ns %= 1000;
+  }
+  return in;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  return exchange(data);
+}
+
+uint16_t SPIClass::transfer16(uint16_t data) {
+  uint16_t hi = exchange(data >> 8);
+  return (hi << 8) | exchange(data & 0xFF);
+}
+
+uint32_t SPIClass::transfer32(uint32_t data) {
+  uint32_t hi = transfer16(data >> 16);
+  return (hi << 16) | transfer16(data & 0xFFFF);
+}
+
+void SPIClass::transfer(const void *buf, void *retbuf, size_t count) {
+  const uint8_t *tx = (const uint8_t *)buf;
+  uint8_t *rx = (uint8_t *)retbuf;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t in = exchange(tx ? tx[i] : _transferWriteFill);
+    if (rx) {
+      rx[i] = in;
+    }
+  }
+}
+
+// the bytes are exchanged up front (chip select is held for the whole transfer anyway),
+// completion is signalled from a one-shot timer once the bus time has passed
+bool SPIClass::transfer(const void *txBuffer, void *rxBuffer, size_t count, EventResponderRef event_responder) {
+  if (dma_active) {
+    return false;
+  }
+  const uint8_t *tx = (const uint8_t *)txBuffer;
+  uint8_t *rx = (uint8_t *)rxBuffer;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t in = Plant::spi_transfer(tx ? tx[i] : _transferWriteFill);
+    if (rx) {
+      rx[i] = in;
+    }
+  }
+
+  dma_active = true;
+  event_responder.clearEvent();
+  uint32_t duration_us = (uint32_t)(((uint64_t)byte_time_ns * count + 999) / 1000);
+  EventResponder *er = &event_responder;
+  dma_timer = Sim::add_timer(duration_us ? duration_us : 1, 0, [this, er]() {
+    dma_active = false;
+    dma_timer = -1;
+    er->triggerEvent();
+  });
+  return true;
+}
+
+// drops the pending completion, timer handles are reused so only cancel our own
+void SPIClass::abortTransfer() {
+  if (dma_timer >= 0) {
+    Sim::cancel(dma_timer);
+    dma_timer = -1;
+  }
+  dma_active = false;
+}
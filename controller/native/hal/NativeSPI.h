@@ -0,0 +1,59 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+/*
+ * NativeSPI.h
+ *
+ *  Description: SPIClass stand-in used by SPI_Fixed.h in the native build. Every byte is exchanged
+ *  with the plant model and costs its real bus time on the virtual clock. The asynchronous transfer
+ *  completes from a timer "interrupt" after the same delay, like the DMA version on the Teensy.
+ */
+
+#include <Arduino.h>
+
+#define SPI_HAS_TRANSFER_ASYNC 1
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clockIn, uint8_t bitOrderIn, uint8_t dataModeIn) : _clock(clockIn), bitOrder(bitOrderIn), dataMode(dataModeIn) {}
+  SPISettings() : _clock(4000000), bitOrder(1), dataMode(0) {}
+
+private:
+  uint32_t _clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+  friend class SPIClass;
+};
+
+class SPIClass {
+public:
+  void begin() {}
+  void end() {}
+  void beginTransaction(SPISettings settings);
+  void endTransaction() { in_transaction = false; }
+  void usingInterrupt(uint8_t) {}
+
+  uint8_t transfer(uint8_t data);
+  uint16_t transfer16(uint16_t data);
+  uint32_t transfer32(uint32_t data);
+  void transfer(void *buf, size_t count) { transfer(buf, buf, count); }
+  void transfer(const void *buf, void *retbuf, size_t count);
+  bool transfer(const void *txBuffer, void *rxBuffer, size_t count, EventResponderRef event_responder);
+  void abortTransfer();
+  void setTransferWriteFill(uint8_t ch) { _transferWriteFill = ch; }
+
+private:
+  uint8_t exchange(uint8_t out);
+  uint32_t byte_time_ns = 2000;
+  uint32_t pending_ns = 0;
+  bool in_transaction = false;
+  bool dma_active = false;
+  int dma_timer = -1;
+  uint8_t _transferWriteFill = 0;
+};
+
+extern SPIClass SPI;
+extern SPIClass SPI1;
+extern SPIClass SPI2;
+
+#endif
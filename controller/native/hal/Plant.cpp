@@ -0,0 +1,481 @@
+#include "Plant.h"
+#include "Arduino.h"
+
+#include <vector>
+
+// pin numbers and device addresses mirror controller/lib/teensy_pins and spi_demux
+#define PIN_ZUCROW_SYNC 15
+#define PIN_ZUCROW_PANIC 16
+#define PIN_TEENSY_SYNC 19
+#define PIN_TEENSY_PANIC 20
+static const uint8_t demux_pins[5] = {29, 28, 4, 3, 2};
+
+#define ADDR_PT_LOX_UPSTREAM 2
+#define ADDR_PT_LOX_DOWNSTREAM 10
+#define ADDR_PT_LOX_DIFFERENTIAL 14
+#define ADDR_PT_IPA_UPSTREAM 0
+#define ADDR_PT_IPA_DOWNSTREAM 4
+#define ADDR_PT_IPA_DIFFERENTIAL 8
+#define ADDR_PT_CHAMBER 18
+#define ADDR_TC 17
+#define ADDR_DAC 24
+
+#define PLANT_STEP_US 1000
+#define HEARTBEAT_INTERVAL_US 100000
+#define ENCODER_INTERVAL_US 10000
+#define CAN_REPLY_DELAY_US 250
+#define SYNC_DELAY_US 500000 // time from teensy OK to zucrow sync
+
+#define ATM 14.7f
+#define TANK_PRESSURE 600.0f
+#define LOX_TEMPERATURE_C -183.0f
+
+// same physical constants as controller/lib/valve_controller
+#define GRAVITY_FT_S 32.1740f
+#define IN3_TO_GAL 0.004329f
+#define DENSITY_WATER 0.0360724f
+#define AREA_OF_THROAT 1.69f
+#define CSTAR 4100.0f
+#define LOX_DENSITY 0.0412f
+#define IPA_DENSITY 0.02836f
+
+namespace {
+
+// ---- fluid model ----
+struct Line {
+  float density;
+  float inj_area;
+  float inj_cd;
+  float venturi_throat;
+  float venturi_inlet;
+  const float (*cv_table)[2];
+  int cv_len;
+
+  float mdot = 0;
+  float upstream = ATM;
+  float downstream = ATM;
+  float differential = 0;
+};
+
+// valve angle (deg) to cv, inverse of the tables in valve_controller.cpp
+const float ox_cv[][2] = {{0, 0}, {25, 0.084}, {30, 0.143}, {35, 0.237}, {40, 0.366}, {45, 0.531}, {50, 0.730}, {55, 0.960}, {60, 1.217}, {65, 1.495}, {70, 1.787}, {75, 2.084}, {80, 2.378}, {95, 2.6}};
+const float ipa_cv[][2] = {{0, 0}, {25, 0.095}, {30, 0.130}, {35, 0.222}, {40, 0.336}, {45, 0.469}, {50, 0.640}, {55, 0.868}, {60, 1.164}, {65, 1.507}, {70, 1.836}, {75, 2.029}, {95, 2.4}};
+
+Line ox{LOX_DENSITY, 0.0498, 0.51, 0.066, 0.127, ox_cv, sizeof(ox_cv) / sizeof(ox_cv[0])};
+Line ipa{IPA_DENSITY, 0.04031, 0.8, 0.062, 0.127, ipa_cv, sizeof(ipa_cv) / sizeof(ipa_cv[0])};
+float tank_target = ATM;
+float tank = ATM;
+float chamber = ATM;
+
+float cv_from_angle(const Line &l, float angle) {
+  if (angle <= l.cv_table[0][0]) {
+    return 0;
+  }
+  for (int i = 0; i < l.cv_len - 1; i++) {
+    if (angle < l.cv_table[i + 1][0]) {
+      float t = (angle - l.cv_table[i][0]) / (l.cv_table[i + 1][0] - l.cv_table[i][0]);
+      return l.cv_table[i][1] + t * (l.cv_table[i + 1][1] - l.cv_table[i][1]);
+    }
+  }
+  return l.cv_table[l.cv_len - 1][1];
+}
+
+float manifold_drop(const Line &l, float mdot) {
+  return mdot * mdot / (2 * l.density * GRAVITY_FT_S * 12 * powf(l.inj_cd * l.inj_area, 2));
+}
+
+// relaxes the line toward the flow the valve passes at the current pressures
+void step_line(Line &l, float angle, float dt) {
+  float cv = cv_from_angle(l, angle);
+  float dp = tank - l.downstream;
+  float target = dp > 0 ? cv * sqrtf(dp * l.density * DENSITY_WATER) / (IN3_TO_GAL * 60) : 0;
+  l.mdot += (target - l.mdot) * min(1.0f, dt / 0.02f);
+  l.upstream = tank;
+
+  float area_term = powf(l.venturi_throat / l.venturi_inlet, 2);
+  l.differential = powf(l.mdot / l.venturi_throat, 2) * (1 - area_term) / (2 * l.density * 12 * GRAVITY_FT_S);
+}
+
+// ---- odrives ----
+struct ODriveSim {
+  uint8_t node_id;
+  uint8_t state = 1; // AXIS_STATE_IDLE
+  uint32_t control_mode = 3;
+  float input_pos = 0.25;
+  float input_vel = 0;
+  float vel_ff = 0; // Set_Input_Pos velocity feed-forward
+  float pos = 0.25; // valve closed, the firmware sends 0.25 - angle
+  float vel = 0;
+  float iq = 0;
+};
+ODriveSim odrives[2] = {{1}, {2}};
+
+#define HARD_STOP_LOW -0.01f
+#define HARD_STOP_HIGH 0.26f
+
+void step_odrive(ODriveSim &o, float dt) {
+  float last = o.pos;
+  o.iq = 0;
+  if (o.state == 8) { // AXIS_STATE_CLOSED_LOOP_CONTROL
+    if (o.control_mode == 2) {
+      o.pos += o.input_vel * dt;
+    } else {
+      o.pos += (o.input_pos - o.pos) * min(1.0f, dt / 0.015f) + o.vel_ff * dt;
+    }
+  }
+  if (o.pos < HARD_STOP_LOW || o.pos > HARD_STOP_HIGH) {
+    o.pos = constrain(o.pos, HARD_STOP_LOW, HARD_STOP_HIGH);
+    o.iq = o.state == 8 ? 25 : 0; // stalled against the stop
+  }
+  o.vel = (o.pos - last) / dt;
+}
+
+float valve_angle(const ODriveSim &o) {
+  return (0.25f - o.pos) * 360;
+}
+
+void put_float(uint8_t *buf, float v) {
+  memcpy(buf, &v, 4);
+}
+
+float get_float(const uint8_t *buf) {
+  float v;
+  memcpy(&v, buf, 4);
+  return v;
+}
+
+int16_t get_i16(const uint8_t *buf) {
+  int16_t v;
+  memcpy(&v, buf, 2);
+  return v;
+}
+
+uint32_t get_u32(const uint8_t *buf) {
+  uint32_t v;
+  memcpy(&v, buf, 4);
+  return v;
+}
+
+// builds the reply for a remote (RTR) request, returns false for commands with no reply
+bool odrive_reply(const ODriveSim &o, uint8_t cmd, uint8_t *buf) {
+  memset(buf, 0, 8);
+  switch (cmd) {
+  case 0x00: // Get_Version
+    buf[0] = 2;
+    buf[1] = 4;
+    buf[2] = 4;
+    buf[4] = 0;
+    buf[5] = 6;
+    buf[6] = 9;
+    return true;
+  case 0x03: // Get_Error
+    return true;
+  case 0x09: // Get_Encoder_Estimates
+    put_float(buf, o.pos);
+    put_float(buf + 4, o.vel);
+    return true;
+  case 0x14: // Get_Iq
+    put_float(buf, o.iq);
+    put_float(buf + 4, o.iq);
+    return true;
+  case 0x15: // Get_Temperature
+    put_float(buf, 35);
+    put_float(buf + 4, 40);
+    return true;
+  case 0x17: // Get_Bus_Voltage_Current
+    put_float(buf, 24);
+    put_float(buf + 4, 0.5f + fabsf(o.iq) * 0.1f);
+    return true;
+  }
+  return false;
+}
+
+bool can_silent = false; // --can-dropout-ms has expired
+
+void send_frame(const ODriveSim &o, uint8_t cmd, const uint8_t *buf) {
+  if (can_silent) {
+    return;
+  }
+  sim_can_receive((o.node_id << 5) | cmd, 8, buf);
+}
+
+void send_heartbeat(const ODriveSim &o) {
+  uint8_t buf[8] = {0};
+  buf[4] = o.state;
+  buf[6] = 1; // trajectory done
+  send_frame(o, 0x01, buf);
+}
+
+void send_encoder(const ODriveSim &o) {
+  uint8_t buf[8];
+  odrive_reply(o, 0x09, buf);
+  send_frame(o, 0x09, buf);
+}
+
+// ---- spi devices ----
+uint8_t demux_address = 0;
+uint8_t frame[16];
+int frame_index = 0;
+uint8_t tc_regs[16];
+int tc_address = -1;
+bool tc_write = false;
+uint16_t dac_command[2];
+uint32_t dac_writes = 0;
+
+uint32_t rng_state = 12345;
+float noise(float scale) {
+  // sum of uniforms is close enough to gaussian for sensor noise
+  float sum = 0;
+  for (int i = 0; i < 4; i++) {
+    rng_state = rng_state * 1664525 + 1013904223;
+    sum += (rng_state >> 8) / 16777216.0f - 0.5f;
+  }
+  return sum * scale;
+}
+
+float pt_slope(uint8_t address) {
+  switch (address) {
+  case ADDR_PT_LOX_UPSTREAM: return 155.98;
+  case ADDR_PT_LOX_DOWNSTREAM: return 103.37;
+  case ADDR_PT_LOX_DIFFERENTIAL: return 4.97;
+  case ADDR_PT_IPA_UPSTREAM: return 158.70;
+  case ADDR_PT_IPA_DOWNSTREAM: return 157.92;
+  case ADDR_PT_IPA_DIFFERENTIAL: return 31.00;
+  case ADDR_PT_CHAMBER: return 51.07;
+  }
+  return 0;
+}
+
+float pt_pressure(uint8_t address) {
+  switch (address) {
+  case ADDR_PT_LOX_UPSTREAM: return ox.upstream;
+  case ADDR_PT_LOX_DOWNSTREAM: return ox.downstream;
+  case ADDR_PT_LOX_DIFFERENTIAL: return ox.differential;
+  case ADDR_PT_IPA_UPSTREAM: return ipa.upstream;
+  case ADDR_PT_IPA_DOWNSTREAM: return ipa.downstream;
+  case ADDR_PT_IPA_DIFFERENTIAL: return ipa.differential;
+  case ADDR_PT_CHAMBER: return chamber;
+  }
+  return 0;
+}
+
+void put24(uint8_t *buf, int32_t v) {
+  buf[0] = (v >> 16) & 0xFF;
+  buf[1] = (v >> 8) & 0xFF;
+  buf[2] = v & 0xFF;
+}
+
+// ADS131M02 output frame: status, ch0, ch1, crc - each one 24 bit word
+void build_pt_frame(uint8_t address) {
+  float slope = pt_slope(address);
+  float volts = (pt_pressure(address) + noise(slope * 0.002f)) / slope / 10; // the board maps 0-10 V to 0-1 V
+  int32_t counts = constrain((int32_t)(-volts * 16777216 / 2.4f), -0x7FFFFF, 0x7FFFFF);
+
+  memset(frame, 0, sizeof(frame));
+  frame[0] = 0x05; // both DRDY bits set
+  frame[1] = 0x03;
+  put24(frame + 6, counts);
+
+  uint16_t crc = 0xFFFF;
+  for (int i = 0; i < 9; i++) {
+    crc ^= (frame[i] << 8);
+    for (int j = 0; j < 8; j++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  frame[9] = crc >> 8;
+  frame[10] = crc & 0xFF;
+}
+
+void update_tc_registers() {
+  int32_t raw = (int32_t)(LOX_TEMPERATURE_C / 0.0078125f) * 32; // 19 bit reading, left aligned in 24 bits
+  tc_regs[0x0C] = (raw >> 16) & 0xFF;
+  tc_regs[0x0D] = (raw >> 8) & 0xFF;
+  tc_regs[0x0E] = raw & 0xFF;
+  tc_regs[0x0A] = 25; // cold junction
+  tc_regs[0x0F] = 0;  // no faults
+}
+
+void on_select(uint8_t address) {
+  frame_index = 0;
+  tc_address = -1;
+  if (pt_slope(address) != 0) {
+    build_pt_frame(address);
+  }
+}
+
+// ---- zucrow ----
+bool zucrow_running = false;
+
+void set_tanks(bool pressurized) {
+  tank_target = pressurized ? TANK_PRESSURE : ATM;
+}
+
+void zucrow_go() {
+  zucrow_running = true;
+  sim_drive_pin(PIN_ZUCROW_SYNC, LOW); // ZUCROW_SYNC_RUNNING
+  if (Sim::options.zucrow_abort_ms) {
+    Sim::add_timer(Sim::options.zucrow_abort_ms * 1000, 0, []() {
+      sim_drive_pin(PIN_ZUCROW_PANIC, LOW); // ZUCROW_PANIC
+    });
+  }
+  if (Sim::options.can_dropout_ms) {
+    Sim::add_timer(Sim::options.can_dropout_ms * 1000, 0, []() {
+      can_silent = true;
+    });
+  }
+}
+
+void zucrow_stop() {
+  zucrow_running = false;
+  sim_drive_pin(PIN_ZUCROW_SYNC, HIGH); // ZUCROW_SYNC_IDLE
+  set_tanks(false);
+}
+
+void plant_step() {
+  float dt = PLANT_STEP_US / 1e6f;
+  tank += (tank_target - tank) * dt / 0.2f;
+
+  for (ODriveSim &o : odrives) {
+    step_odrive(o, dt);
+  }
+  step_line(ox, valve_angle(odrives[0]), dt);
+  step_line(ipa, valve_angle(odrives[1]), dt);
+
+  float mdot = ox.mdot + ipa.mdot;
+  float target_chamber = ATM + mdot * CSTAR / (AREA_OF_THROAT * GRAVITY_FT_S);
+  chamber += (target_chamber - chamber) * min(1.0f, dt / 0.01f);
+  ox.downstream = chamber + manifold_drop(ox, ox.mdot);
+  ipa.downstream = chamber + manifold_drop(ipa, ipa.mdot);
+}
+
+} // namespace
+
+namespace Plant {
+
+void begin() {
+  update_tc_registers();
+  sim_drive_pin(PIN_ZUCROW_SYNC, HIGH);  // ZUCROW_SYNC_IDLE
+  sim_drive_pin(PIN_ZUCROW_PANIC, HIGH); // ZUCROW_NO_PANIC
+
+  Sim::add_timer(PLANT_STEP_US, PLANT_STEP_US, plant_step);
+  Sim::add_timer(HEARTBEAT_INTERVAL_US, HEARTBEAT_INTERVAL_US, []() {
+    for (ODriveSim &o : odrives) {
+      send_heartbeat(o);
+    }
+  });
+  Sim::add_timer(ENCODER_INTERVAL_US, ENCODER_INTERVAL_US, []() {
+    for (ODriveSim &o : odrives) {
+      send_encoder(o);
+    }
+  });
+}
+
+void pin_written(uint8_t pin, uint8_t val) {
+  for (int i = 0; i < 5; i++) {
+    if (pin == demux_pins[i]) {
+      uint8_t address = (demux_address & ~(1 << i)) | (val ? 1 << i : 0);
+      if (address != demux_address) {
+        demux_address = address;
+        on_select(address);
+      }
+      return;
+    }
+  }
+
+  if (pin == PIN_TEENSY_PANIC) {
+    if (val) { // TEENSY_PANIC
+      zucrow_stop();
+    } else {
+      set_tanks(true);
+      Sim::add_timer(SYNC_DELAY_US, 0, zucrow_go);
+    }
+  }
+  if (pin == PIN_TEENSY_SYNC && !val && zucrow_running) { // TEENSY_SYNC_IDLE after a curve
+    zucrow_stop();
+  }
+}
+
+bool pin_input(uint8_t, uint8_t *) {
+  return false; // inputs are driven with sim_drive_pin
+}
+
+uint8_t spi_transfer(uint8_t out) {
+  uint8_t in = 0;
+  if (pt_slope(demux_address) != 0) {
+    in = frame_index < (int)sizeof(frame) ? frame[frame_index] : 0;
+  } else if (demux_address == ADDR_TC) {
+    if (frame_index == 0) {
+      tc_address = out & 0x7F;
+      tc_write = out & 0x80;
+      update_tc_registers();
+    } else if (tc_address >= 0) {
+      if (tc_write) {
+        if (tc_address < 0x0C) {
+          tc_regs[tc_address] = out;
+        }
+      } else {
+        in = tc_regs[tc_address];
+      }
+      tc_address = (tc_address + 1) & 0x0F;
+    }
+  } else if (demux_address == ADDR_DAC || demux_address == ADDR_DAC + 1) {
+    if (frame_index == 0) {
+      dac_command[0] = out << 8;
+    } else if (frame_index == 1) {
+      dac_command[0] |= out;
+      dac_command[(dac_command[0] >> 15) & 1] = dac_command[0];
+      dac_writes++;
+    }
+  }
+  frame_index++;
+  return in;
+}
+
+void can_write(uint32_t id, bool remote, uint8_t len, const uint8_t *buf) {
+  uint8_t node = (id >> 5) & 0x3F;
+  uint8_t cmd = id & 0x1F;
+  for (ODriveSim &o : odrives) {
+    if (o.node_id != node) {
+      continue;
+    }
+    if (remote) {
+      uint8_t reply[8];
+      if (odrive_reply(o, cmd, reply)) {
+        ODriveSim *op = &o;
+        Sim::add_timer(CAN_REPLY_DELAY_US, 0, [op, cmd]() {
+          uint8_t reply[8];
+          odrive_reply(*op, cmd, reply);
+          send_frame(*op, cmd, reply);
+        });
+      }
+      return;
+    }
+    switch (cmd) {
+    case 0x07: // Set_Axis_State
+      o.state = get_u32(buf);
+      if (o.state == 8) {
+        o.input_pos = o.pos;
+        o.vel_ff = 0;
+      }
+      break;
+    case 0x0B: // Set_Controller_Mode
+      o.control_mode = get_u32(buf);
+      break;
+    case 0x0C: // Set_Input_Pos
+      o.input_pos = get_float(buf);
+      o.vel_ff = get_i16(buf + 4) * 0.001f;
+      break;
+    case 0x0D: // Set_Input_Vel
+      o.input_vel = get_float(buf);
+      break;
+    case 0x19: // Set_Absolute_Position
+      o.pos = get_float(buf);
+      o.input_pos = o.pos;
+      break;
+    }
+    (void)len;
+  }
+}
+
+} // namespace Plant
@@ -0,0 +1,37 @@
+#ifndef NATIVE_PLANT_H
+#define NATIVE_PLANT_H
+
+/*
+ * Plant.h
+ *
+ *  Description: Models of everything on the other end of the Teensy's wires for the native build:
+ *  the PT (ADS131M02) and TC (MAX31856) boards and the Zucrow DAC behind the SPI demux, the two
+ *  ODrives on CAN3, and the Zucrow sync/panic lines. The fluid model is deliberately crude - it
+ *  only needs to produce plausible, valve-dependent sensor values so full curves can run.
+ */
+
+#include <stdint.h>
+
+namespace Plant {
+
+void begin();
+
+// gpio hooks - called by digitalWrite / digitalRead
+void pin_written(uint8_t pin, uint8_t val);
+bool pin_input(uint8_t pin, uint8_t *val);
+
+// exchanges one byte with whichever SPI device the demux currently selects
+uint8_t spi_transfer(uint8_t out);
+
+// handles a frame sent by the Teensy on CAN3
+void can_write(uint32_t id, bool remote, uint8_t len, const uint8_t *buf);
+
+} // namespace Plant
+
+// drives an input pin from the plant side, firing any attached pin interrupt on a matching edge
+void sim_drive_pin(uint8_t pin, uint8_t val);
+
+// delivers a CAN frame to the handler registered with FlexCAN_T4::onReceive
+void sim_can_receive(uint32_t id, uint8_t len, const uint8_t *buf);
+
+#endif
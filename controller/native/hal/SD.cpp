@@ -0,0 +1,233 @@
+#include "SD.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SDClass SD;
+
+struct NativeFileHandle {
+  FILE *fp = nullptr;
+  DIR *dir = nullptr;
+  std::string path;
+  std::string name;
+
+  ~NativeFileHandle() {
+    if (fp) {
+      fclose(fp);
+    }
+    if (dir) {
+      closedir(dir);
+    }
+  }
+};
+
+namespace {
+std::shared_ptr<NativeFileHandle> open_handle(const std::string &path, const std::string &name, uint8_t mode) {
+  struct stat st;
+  auto h = std::make_shared<NativeFileHandle>();
+  h->path = path;
+  h->name = name;
+  if (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    h->dir = opendir(path.c_str());
+    return h->dir ? h : nullptr;
+  }
+
+  if (mode == FILE_READ) {
+    h->fp = fopen(path.c_str(), "rb");
+  } else {
+    // FILE_WRITE appends (O_RDWR | O_CREAT | O_AT_END on the Teensy), FILE_WRITE_BEGIN starts at 0
+    h->fp = fopen(path.c_str(), "r+b");
+    if (h->fp == nullptr) {
+      h->fp = fopen(path.c_str(), "w+b");
+    }
+    if (h->fp && mode == FILE_WRITE) {
+      fseek(h->fp, 0, SEEK_END);
+    }
+  }
+  return h->fp ? h : nullptr;
+}
+} // namespace
+
+// ---- File ----
+size_t File::write(const uint8_t *buf, size_t size) {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  return fwrite(buf, 1, size, handle->fp);
+}
+
+int File::available() {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  uint64_t remaining = size() - position();
+  return remaining > 0x7FFFFFFF ? 0x7FFFFFFF : (int)remaining;
+}
+
+int File::read() {
+  if (!handle || !handle->fp) {
+    return -1;
+  }
+  int c = fgetc(handle->fp);
+  return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+  int c = read();
+  if (c >= 0) {
+    ungetc(c, handle->fp);
+  }
+  return c;
+}
+
+int File::read(void *buf, size_t nbyte) {
+  if (!handle || !handle->fp) {
+    return -1;
+  }
+  return fread(buf, 1, nbyte, handle->fp);
+}
+
+void File::flush() {
+  if (handle && handle->fp) {
+    fflush(handle->fp);
+  }
+}
+
+bool File::seek(uint64_t pos) {
+  return handle && handle->fp && fseek(handle->fp, pos, SEEK_SET) == 0;
+}
+
+uint64_t File::position() {
+  return handle && handle->fp ? ftell(handle->fp) : 0;
+}
+
+uint64_t File::size() {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  long pos = ftell(handle->fp);
+  fseek(handle->fp, 0, SEEK_END);
+  long end = ftell(handle->fp);
+  fseek(handle->fp, pos, SEEK_SET);
+  return end;
+}
+
+void File::close() {
+  handle = nullptr;
+}
+
+bool File::isDirectory() {
+  return handle && handle->dir;
+}
+
+const char *File::name() {
+  return handle ? handle->name.c_str() : "";
+}
+
+File File::openNextFile(uint8_t mode) {
+  if (!handle || !handle->dir) {
+    return File();
+  }
+  struct dirent *entry;
+  while ((entry = readdir(handle->dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      return File(open_handle(handle->path + "/" + entry->d_name, entry->d_name, mode));
+    }
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (handle && handle->dir) {
+    rewinddir(handle->dir);
+  }
+}
+
+// ---- FsFile ----
+size_t FsFile::write(const void *buf, size_t count) {
+  return handle && handle->fp ? fwrite(buf, 1, count, handle->fp) : 0;
+}
+
+bool FsFile::truncate() {
+  if (!handle || !handle->fp) {
+    return false;
+  }
+  fflush(handle->fp);
+  return ftruncate(fileno(handle->fp), ftell(handle->fp)) == 0;
+}
+
+bool FsFile::seekEnd() {
+  return handle && handle->fp && fseek(handle->fp, 0, SEEK_END) == 0;
+}
+
+uint64_t FsFile::curPosition() {
+  return handle && handle->fp ? ftell(handle->fp) : 0;
+}
+
+bool FsFile::sync() {
+  return handle && handle->fp && fflush(handle->fp) == 0;
+}
+
+bool FsFile::close() {
+  handle = nullptr;
+  return true;
+}
+
+FsFile SdFs::open(const char *path, int oflag) {
+  int fd = ::open(SD.host_path(path).c_str(), oflag, 0644);
+  if (fd < 0) {
+    return FsFile();
+  }
+  auto h = std::make_shared<NativeFileHandle>();
+  h->path = SD.host_path(path);
+  const char *slash = strrchr(path, '/');
+  h->name = slash ? slash + 1 : path;
+  h->fp = fdopen(fd, (oflag & O_ACCMODE) == O_RDONLY ? "rb" : "r+b");
+  return h->fp ? FsFile(h) : FsFile();
+}
+
+// ---- SDClass ----
+std::string SDClass::host_path(const char *filepath) {
+  std::string path = Sim::options.sd_dir;
+  if (filepath[0] != '/') {
+    path += "/";
+  }
+  return path + filepath;
+}
+
+bool SDClass::begin(uint8_t) {
+  ::mkdir(Sim::options.sd_dir, 0755);
+  struct stat st;
+  return stat(Sim::options.sd_dir, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+File SDClass::open(const char *filepath, uint8_t mode) {
+  const char *slash = strrchr(filepath, '/');
+  return File(open_handle(host_path(filepath), slash ? slash + 1 : filepath, mode));
+}
+
+bool SDClass::exists(const char *filepath) {
+  struct stat st;
+  return stat(host_path(filepath).c_str(), &st) == 0;
+}
+
+bool SDClass::mkdir(const char *filepath) {
+  return ::mkdir(host_path(filepath).c_str(), 0755) == 0;
+}
+
+bool SDClass::remove(const char *filepath) {
+  return ::remove(host_path(filepath).c_str()) == 0;
+}
+
+bool SDClass::rename(const char *oldfilepath, const char *newfilepath) {
+  if (exists(newfilepath)) {
+    return false; // like FAT, which won't replace an existing file
+  }
+  return ::rename(host_path(oldfilepath).c_str(), host_path(newfilepath).c_str()) == 0;
+}
+
+bool SDClass::rmdir(const char *filepath) {
+  return ::rmdir(host_path(filepath).c_str()) == 0;
+}
@@ -0,0 +1,100 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+/*
+ * SD.h
+ *
+ *  Description: SD library stand-in for the native build. The card is a directory on the host
+ *  (--sd, default ./sdcard), files are plain host files. SD.sdfs gives the SdFat level FsFile
+ *  for the calls the File wrapper doesn't expose (preAllocate, truncate at the current position).
+ */
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+
+#include "pins_arduino.h"
+
+#define FILE_READ 0
+#define FILE_WRITE 1
+#define FILE_WRITE_BEGIN 2
+
+struct NativeFileHandle;
+
+class File : public Stream {
+public:
+  File() {}
+  File(std::shared_ptr<NativeFileHandle> handle) : handle(handle) {}
+
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+  size_t write(const char *buf, size_t size) { return write((const uint8_t *)buf, size); }
+  using Print::write;
+  int availableForWrite() override { return 4096; }
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(void *buf, size_t nbyte);
+  void flush() override;
+  bool seek(uint64_t pos);
+  uint64_t position();
+  uint64_t size();
+  void close();
+  bool isDirectory();
+  const char *name();
+  File openNextFile(uint8_t mode = FILE_READ);
+  void rewindDirectory();
+  operator bool() const { return handle != nullptr; }
+
+protected:
+  int timedRead() override { return read(); }
+
+private:
+  std::shared_ptr<NativeFileHandle> handle;
+};
+
+// SdFat file, only the calls the firmware uses
+class FsFile {
+public:
+  FsFile() {}
+  FsFile(std::shared_ptr<NativeFileHandle> handle) : handle(handle) {}
+
+  size_t write(const void *buf, size_t count);
+  bool preAllocate(uint64_t) { return isOpen(); }        // host files don't fragment, nothing to reserve
+  bool truncate();                                       // ends the file at the current position
+  bool seekEnd();
+  uint64_t curPosition();
+  bool sync();
+  bool close();
+  bool isOpen() const { return handle != nullptr; }
+  operator bool() const { return isOpen(); }
+
+private:
+  std::shared_ptr<NativeFileHandle> handle;
+};
+
+class SdFs {
+public:
+  FsFile open(const char *path, int oflag = O_RDONLY);
+};
+
+class SDClass {
+public:
+  SdFs sdfs;
+
+  bool begin(uint8_t csPin = BUILTIN_SDCARD);
+  File open(const char *filepath, uint8_t mode = FILE_READ);
+  bool exists(const char *filepath);
+  bool mkdir(const char *filepath);
+  bool remove(const char *filepath);
+  bool rename(const char *oldfilepath, const char *newfilepath);
+  bool rmdir(const char *filepath);
+
+  // host path for a card path, used by the rest of the native HAL
+  std::string host_path(const char *filepath);
+};
+
+extern SDClass SD;
+
+#endif
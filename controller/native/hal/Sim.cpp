@@ -0,0 +1,118 @@
+#include "Sim.h"
+
+#include <unistd.h>
+#include <vector>
+
+namespace Sim {
+
+Options options;
+
+namespace {
+struct SimTimer {
+  uint64_t next_us;
+  uint32_t period_us; // 0 for one-shot
+  std::function<void()> fn;
+  bool active;
+};
+
+uint64_t sim_time_us = 0;
+int irq_disable_depth = 0;
+int isr_depth = 0;
+std::vector<SimTimer> timers;
+
+// returns the index of the earliest active timer due at or before limit, or -1
+int next_due(uint64_t limit) {
+  int best = -1;
+  for (size_t i = 0; i < timers.size(); i++) {
+    if (timers[i].active && timers[i].next_us <= limit && (best < 0 || timers[i].next_us < timers[best].next_us)) {
+      best = i;
+    }
+  }
+  return best;
+}
+} // namespace
+
+uint64_t now_us() {
+  return sim_time_us;
+}
+
+void run_isr(const std::function<void()> &fn) {
+  isr_depth++;
+  fn();
+  isr_depth--;
+}
+
+void advance(uint32_t us) {
+  uint64_t target = sim_time_us + us;
+  // an ISR cannot be preempted by another one of the same priority, and masked code cannot be interrupted
+  if (isr_depth > 0 || irq_disable_depth > 0) {
+    sim_time_us = target;
+    return;
+  }
+
+  int idx;
+  while ((idx = next_due(target)) >= 0) {
+    if (timers[idx].next_us > sim_time_us) {
+      sim_time_us = timers[idx].next_us;
+    }
+    std::function<void()> fn = timers[idx].fn; // timers may be added while firing
+    if (timers[idx].period_us) {
+      timers[idx].next_us += timers[idx].period_us;
+    } else {
+      timers[idx].active = false;
+    }
+    run_isr(fn);
+  }
+  if (target > sim_time_us) {
+    sim_time_us = target;
+  }
+}
+
+void idle(bool waiting_for_input) {
+  if (waiting_for_input) {
+    usleep(1000); // nothing to do until the operator types, so track wall time
+    advance(1000);
+    return;
+  }
+
+  int idx = next_due(UINT64_MAX);
+  uint64_t step = 1000;
+  if (idx >= 0 && timers[idx].next_us > sim_time_us && timers[idx].next_us - sim_time_us < step) {
+    step = timers[idx].next_us - sim_time_us;
+  }
+  advance(step ? step : 1);
+}
+
+int add_timer(uint32_t first_delay_us, uint32_t period_us, std::function<void()> fn) {
+  SimTimer t{sim_time_us + first_delay_us, period_us, fn, true};
+  for (size_t i = 0; i < timers.size(); i++) {
+    if (!timers[i].active) {
+      timers[i] = t;
+      return i;
+    }
+  }
+  timers.push_back(t);
+  return timers.size() - 1;
+}
+
+void cancel(int handle) {
+  if (handle >= 0 && handle < (int)timers.size()) {
+    timers[handle].active = false;
+  }
+}
+
+void irq_disable() {
+  irq_disable_depth++;
+}
+
+void irq_enable() {
+  if (irq_disable_depth > 0) {
+    irq_disable_depth--;
+  }
+}
+
+bool in_isr() {
+  return isr_depth > 0;
+}
+
+} // namespace Sim
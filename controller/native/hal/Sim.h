@@ -0,0 +1,49 @@
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+/*
+ * Sim.h
+ *
+ *  Description: Virtual clock and interrupt emulation for the native (workstation) build.
+ *  Time only moves when firmware code reads the clock, delays, or yields, so a curve runs
+ *  as fast as the host allows while IntervalTimers, CAN traffic and pin edges still fire
+ *  in the order they would on the Teensy.
+ */
+
+#include <stdint.h>
+#include <functional>
+
+namespace Sim {
+
+// virtual microseconds since boot
+uint64_t now_us();
+
+// moves virtual time forward, firing any timers that come due on the way
+void advance(uint32_t us);
+
+// called from yield() - jumps to the next pending timer so idle loops do not spin
+void idle(bool waiting_for_input);
+
+// register a timer that fires in "interrupt" context, returns a handle for cancel()
+int add_timer(uint32_t first_delay_us, uint32_t period_us, std::function<void()> fn);
+void cancel(int handle);
+
+// interrupt masking (noInterrupts / interrupts) and ISR bookkeeping
+void irq_disable();
+void irq_enable();
+bool in_isr();
+void run_isr(const std::function<void()> &fn);
+
+// command line options shared by the stand-in back-ends
+struct Options {
+  bool stdio = false;           // use stdin/stdout instead of a pty for Serial
+  const char *sd_dir = "sdcard"; // host directory that backs the SD card
+  uint32_t zucrow_abort_ms = 0;  // plant raises the Zucrow panic line this long after sync, 0 = never
+  uint32_t can_dropout_ms = 0;   // odrives stop sending frames this long after sync, 0 = never
+  const char *eeprom_file = nullptr; // host file that backs the EEPROM, memory only if not set
+};
+extern Options options;
+
+} // namespace Sim
+
+#endif
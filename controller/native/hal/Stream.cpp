@@ -0,0 +1,90 @@
+#include "Arduino.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t count = 0;
+  while (size--) {
+    count += write(*buffer++);
+  }
+  return count;
+}
+
+int Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  write(buf);
+  return len;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    Sim::idle(true);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+// like the Teensy core, this null terminates the buffer
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+  if (length < 1) {
+    return 0;
+  }
+  length--;
+  size_t index = 0;
+  while (index < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) {
+      break;
+    }
+    *buffer++ = (char)c;
+    index++;
+  }
+  *buffer = 0;
+  return index;
+}
+
+String Stream::readString(size_t max) {
+  String str;
+  while (str.length() < max) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    str += (char)c;
+  }
+  return str;
+}
+
+String Stream::readStringUntil(char terminator, size_t max) {
+  String str;
+  while (str.length() < max) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) {
+      break;
+    }
+    str += (char)c;
+  }
+  return str;
+}
@@ -0,0 +1,66 @@
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+// Print and Stream stand-ins for the native build, following the Teensy core signatures
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = DEC) { return print(String(n, base)); }
+  size_t print(unsigned long n, int base = DEC) { return print(String(n, base)); }
+  size_t print(long long n, int base = DEC) { return print(String(n, base)); }
+  size_t print(unsigned long long n, int base = DEC) { return print(String(n, base)); }
+  size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T &v) { return print(v) + println(); }
+  template <typename T>
+  size_t println(const T &v, int fmt) { return print(v, fmt) + println(); }
+
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+  String readString(size_t max = 120);
+  String readStringUntil(char terminator, size_t max = 120);
+
+protected:
+  // blocks (while yielding) until a byte arrives or the timeout passes, returns -1 on timeout
+  virtual int timedRead();
+  unsigned long _timeout = 1000;
+};
+
+#endif
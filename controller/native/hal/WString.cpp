@@ -0,0 +1,47 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+namespace {
+std::string to_base(unsigned long num, unsigned char base) {
+  if (base < 2 || base > 16) {
+    base = 10;
+  }
+  std::string out;
+  do {
+    out.insert(out.begin(), "0123456789ABCDEF"[num % base]);
+    num /= base;
+  } while (num);
+  return out;
+}
+} // namespace
+
+String::String(long num, unsigned char base) {
+  if (base == 10 && num < 0) {
+    s = "-" + to_base(-(unsigned long)num, base);
+  } else {
+    s = to_base(num, base);
+  }
+}
+
+String::String(unsigned long num, unsigned char base) : s(to_base(num, base)) {
+}
+
+String::String(float num, unsigned char digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, num);
+  s = buf;
+}
+
+void String::trim() {
+  size_t begin = 0;
+  while (begin < s.size() && isspace((unsigned char)s[begin])) {
+    begin++;
+  }
+  size_t end = s.size();
+  while (end > begin && isspace((unsigned char)s[end - 1])) {
+    end--;
+  }
+  s = s.substr(begin, end - begin);
+}
@@ -0,0 +1,77 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+// Arduino String stand-in for the native build, backed by std::string
+
+#include <stdlib.h>
+#include <string>
+
+class String {
+public:
+  String(const char *cstr = "") : s(cstr ? cstr : "") {}
+  String(const std::string &str) : s(str) {}
+  String(char c) : s(1, c) {}
+  String(unsigned char num, unsigned char base = 10) : String((unsigned long)num, base) {}
+  String(int num, unsigned char base = 10) : String((long)num, base) {}
+  String(unsigned int num, unsigned char base = 10) : String((unsigned long)num, base) {}
+  String(long num, unsigned char base = 10);
+  String(unsigned long num, unsigned char base = 10);
+  String(long long num, unsigned char base = 10) : String((long)num, base) {}
+  String(unsigned long long num, unsigned char base = 10) : String((unsigned long)num, base) {}
+  String(float num, unsigned char digits = 2);
+  String(double num, unsigned char digits = 2) : String((float)num, digits) {}
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.length(); }
+  char operator[](unsigned int i) const { return i < s.length() ? s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  String &operator+=(const String &rhs) {
+    s += rhs.s;
+    return *this;
+  }
+  String &operator+=(const char *rhs) {
+    s += rhs;
+    return *this;
+  }
+  String &operator+=(char c) {
+    s += c;
+    return *this;
+  }
+  template <typename T>
+  String &operator+=(T v) { return *this += String(v); }
+  bool concat(const String &rhs) {
+    s += rhs.s;
+    return true;
+  }
+
+  bool equals(const String &rhs) const { return s == rhs.s; }
+  bool equals(const char *rhs) const { return s == rhs; }
+  bool operator==(const String &rhs) const { return s == rhs.s; }
+  bool operator==(const char *rhs) const { return s == rhs; }
+  bool operator!=(const String &rhs) const { return s != rhs.s; }
+  bool operator!=(const char *rhs) const { return s != rhs; }
+  bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t i = s.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  String substring(unsigned int begin) const { return begin < s.size() ? String(s.substr(begin)) : String(); }
+  String substring(unsigned int begin, unsigned int end) const {
+    return begin < s.size() && end > begin ? String(s.substr(begin, end - begin)) : String();
+  }
+
+  void trim();
+  void reserve(unsigned int size) { s.reserve(size); }
+  long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s.c_str(), nullptr); }
+
+  friend String operator+(const String &lhs, const String &rhs) { return String(lhs.s + rhs.s); }
+  friend String operator+(const char *lhs, const String &rhs) { return String(lhs + rhs.s); }
+  friend String operator+(const String &lhs, const char *rhs) { return String(lhs.s + rhs); }
+
+private:
+  std::string s;
+};
+
+#endif
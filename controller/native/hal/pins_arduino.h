@@ -0,0 +1,9 @@
+#ifndef NATIVE_PINS_ARDUINO_H
+#define NATIVE_PINS_ARDUINO_H
+
+// pin definitions are not needed by the native build, the header only has to exist for SPI_Fixed.cpp
+
+#define CORE_NUM_DIGITAL 55
+#define BUILTIN_SDCARD 254
+
+#endif
@@ -3,12 +3,21 @@
 #include "ZucrowInterface.h"
 #include "CurveFollower.h"
 #include "PressureSensor.h"
+#include "PTCalibration.h"
 #include "Thermocouples.h"
 #include "SPI_Demux.h"
+#include "SPIBus.h"
 #include "Driver.h"
 #include "Router.h"
+#include "LoopProfiler.h"
+#include "CurveLogger.h"
+#include "FlightRecorder.h"
+#include "Telemetry.h"
+#include "LogReplay.h"
 #include "Loader.h"
 #include "Safety.h"
+#include "Scheduler.h"
+#include "Watchdog.h"
 
 void ping() {
   Router::info("pong");
@@ -24,18 +33,30 @@ void setup() {
 
   Router::add({ping, "ping"}); // example registration
   Router::add({help, "help"});
+  Scheduler::begin(); // registers the task report
 
   Safety::begin();          // prints safety info
+  Watchdog::begin();        // reports a watchdog reset of the last boot
   SPI_Demux::begin();       // initializes the SPI backplane
+  SPIBus::begin();          // registers the spi_stats command
   Loader::begin();          // registers data loader functions with the router
   Driver::begin();          // initializes the odrives
   ZucrowInterface::begin(); // initializes the DAC
   PT::begin();              // initializes the PT Boards
+  PTCal::begin();           // loads the PT calibrations from SD
   TC::begin();              // initializes the TC Boards
   CurveFollower::begin();   // creates curve following commands
-  ZucrowInterface::report_angles_for_five_seconds();
+  LoopProfiler::begin();    // registers the loop timing report
+  CurveLogger::begin();     // registers the log writer report
+  FlightRecorder::begin();  // registers the flight recorder dump
+  Telemetry::begin();       // registers live telemetry
+  LogReplay::begin();       // registers the controller log replay
+  ZucrowInterface::report_angles();
+
+  // commands only run once everything above is set up, even though the ODrive connection already runs tasks
+  Scheduler::every("router", 0, Router::poll);
 }
 
 void loop() {
-  Router::run(); // loop only runs once, since there is an internal loop in Router::run()
+  Scheduler::run(); // command line, telemetry, angle readout and whatever else is due
 }
\ No newline at end of file
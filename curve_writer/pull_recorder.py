@@ -0,0 +1,23 @@
+import struct
+import serial
+
+port = 'COM10'
+
+fname = input("Enter a filename (.LOG) and press enter to dump the flight recorder: ")
+device = serial.Serial(port, 115200, timeout=5)
+
+device.write("dump_recorder\nserial\n".encode())
+line = device.readline().decode() # prompt followed by "RECORDER <records>"
+records = int(line.split("RECORDER")[1])
+
+# curve_log_header (CurveLog.h), then the schema, then num_fields 4 byte values per record
+header = device.read(12)
+magic, version, num_fields, schema_size, reserved = struct.unpack("<IHHHH", header)
+schema = device.read(schema_size)
+data = device.read(records * num_fields * 4)
+if len(data) < records * num_fields * 4:
+    print(f"Timed out, got {len(data) // (num_fields * 4)} of {records} records.")
+
+with open("curve_writer/data/" + fname, "wb") as f:
+    f.write(header + schema + data)
+print(f"Wrote {fname}, decode with log_decoder.")
@@ -0,0 +1,111 @@
+// THIS FILE IS FOR RUNNING ON A COMPUTER TO CONVERT BINARY CURVE LOGS TO CSV
+// (PLEASE DON'T RUN ON THE TEENSY)
+//
+// build: g++ -O2 -o log_decoder log_decoder/log_decoder.cpp
+// usage: log_decoder RUN1.LOG [RUN1.CSV]   (writes to stdout without an output file)
+
+#include "../CurveLog.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct column {
+  char type;
+  std::string name;
+};
+
+// reads the header and schema, returns false if the file is not a curve log this tool understands
+bool read_schema(std::ifstream &in, std::vector<column> &columns) {
+  curve_log_header header;
+  if (!in.read((char *)&header, sizeof(header)) || header.magic != CURVE_LOG_MAGIC) {
+    std::cerr << "Not a binary curve log." << std::endl;
+    return false;
+  }
+  if (header.version != CURRENT_CURVELOGH_VERSION) {
+    std::cerr << "Log version " << header.version << ", this decoder reads version " << CURRENT_CURVELOGH_VERSION << std::endl;
+    return false;
+  }
+
+  std::vector<char> schema(header.schema_size);
+  if (!in.read(schema.data(), schema.size())) {
+    std::cerr << "Log ends inside its schema." << std::endl;
+    return false;
+  }
+  size_t pos = 0;
+  for (int i = 0; i < header.num_fields; i++) {
+    const char *end = pos + 1 < schema.size() ? (const char *)memchr(&schema[pos + 1], '\0', schema.size() - pos - 1) : nullptr;
+    if (end == nullptr) {
+      std::cerr << "Malformed schema." << std::endl;
+      return false;
+    }
+    column c;
+    c.type = schema[pos];
+    c.name = &schema[pos + 1];
+    if (c.type != CURVE_LOG_FLOAT && c.type != CURVE_LOG_UINT) {
+      std::cerr << "Column " << c.name << " has unknown type '" << c.type << "'" << std::endl;
+      return false;
+    }
+    columns.push_back(c);
+    pos = end - schema.data() + 1;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " LOG [CSV]" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "Could not open " << argv[1] << std::endl;
+    return 1;
+  }
+  FILE *out = argc == 3 ? fopen(argv[2], "w") : stdout;
+  if (out == nullptr) {
+    std::cerr << "Could not create " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::vector<column> columns;
+  if (!read_schema(in, columns)) {
+    return 1;
+  }
+
+  for (size_t i = 0; i < columns.size(); i++) {
+    fprintf(out, i ? ",%s" : "%s", columns[i].name.c_str());
+  }
+  fprintf(out, "\n");
+
+  std::vector<uint32_t> record(columns.size());
+  size_t rows = 0;
+  while (in.read((char *)record.data(), record.size() * sizeof(uint32_t))) {
+    for (size_t i = 0; i < columns.size(); i++) {
+      if (i) {
+        fputc(',', out);
+      }
+      if (columns[i].type == CURVE_LOG_FLOAT) {
+        float value;
+        memcpy(&value, &record[i], sizeof(value));
+        fprintf(out, "%.7g", value);
+      } else {
+        fprintf(out, "%u", record[i]);
+      }
+    }
+    fputc('\n', out);
+    rows++;
+  }
+  if (in.gcount() > 0) {
+    std::cerr << "Dropped a partial last record (" << in.gcount() << " bytes), the log was cut off." << std::endl;
+  }
+
+  if (out != stdout) {
+    fclose(out);
+  }
+  std::cerr << "Decoded " << rows << " rows." << std::endl;
+  return 0;
+}
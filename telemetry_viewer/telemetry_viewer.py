@@ -0,0 +1,185 @@
+# THIS FILE IS FOR RUNNING ON A COMPUTER TO WATCH THE CONTROLLER'S LIVE TELEMETRY
+# frame format: controller/lib/telemetry/Telemetry.h
+#
+# usage: python3 telemetry_viewer.py [--port /dev/ttyACM0] [--channels all] [--csv out.csv] [--plot lox_pos,ipa_pos]
+# console text from the controller is printed as it arrives, type commands into the prompt as usual
+
+import argparse
+import struct
+import sys
+import threading
+import time
+from collections import deque
+
+TELEMETRY_DATA = 1
+TELEMETRY_SCHEMA = 2
+HEADER = struct.Struct("<BHI")  # type, sequence, micros()
+PLOT_SECONDS = 10
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_schema(payload):
+    columns = []
+    pos = 0
+    while pos < len(payload):
+        end = payload.index(b"\0", pos + 1)
+        columns.append((chr(payload[pos]), payload[pos + 1:end].decode()))
+        pos = end + 1
+    return columns
+
+
+class Receiver:
+    """Splits the serial stream into frames, keeps the schema and hands decoded rows to on_row."""
+
+    def __init__(self, on_row, on_text):
+        self.on_row = on_row
+        self.on_text = on_text
+        self.buffer = bytearray()
+        self.columns = None
+        self.last_sequence = None
+        self.frames = 0
+        self.lost = 0
+        self.bad = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            end = self.buffer.find(b"\0")
+            if end < 0:
+                return
+            chunk = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if chunk:
+                self.chunk(chunk)
+
+    def chunk(self, chunk):
+        frame = cobs_decode(chunk)
+        if frame is None or len(frame) < HEADER.size + 2 or crc16(frame[:-2]) != struct.unpack("<H", frame[-2:])[0]:
+            if all(32 <= b < 127 or b in b"\r\n\t" for b in chunk):
+                self.on_text(chunk.decode())
+            else:
+                self.bad += 1
+            return
+
+        kind, sequence, time_us = HEADER.unpack(frame[:HEADER.size])
+        payload = frame[HEADER.size:-2]
+        if self.last_sequence is not None:
+            self.lost += (sequence - self.last_sequence - 1) & 0xFFFF
+        self.last_sequence = sequence
+        self.frames += 1
+
+        if kind == TELEMETRY_SCHEMA:
+            columns = parse_schema(payload)
+            if columns != self.columns:
+                self.columns = columns
+                self.on_row(None, columns)
+        elif kind == TELEMETRY_DATA and self.columns and len(payload) == 4 * len(self.columns):
+            fmt = "<" + "".join("f" if t == "f" else "I" for t, _ in self.columns)
+            self.on_row(time_us, struct.unpack(fmt, payload))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Live telemetry viewer")
+    parser.add_argument("--port", default="/dev/ttyACM0")
+    parser.add_argument("--channels", default="all", help="comma separated curve log columns, or all")
+    parser.add_argument("--csv", help="write every received row to this file")
+    parser.add_argument("--plot", help="comma separated channels to plot live")
+    args = parser.parse_args()
+
+    import serial
+    device = serial.Serial(args.port, 115200, timeout=0.05)
+
+    csv_file = open(args.csv, "w") if args.csv else None
+    plot_names = args.plot.split(",") if args.plot else []
+    history = {name: deque() for name in plot_names}
+    lock = threading.Lock()
+    state = {"columns": []}
+
+    def on_row(time_us, values):
+        if time_us is None:  # new schema
+            state["columns"] = [name for _, name in values]
+            if csv_file:
+                csv_file.write("micros," + ",".join(state["columns"]) + "\n")
+            return
+        if csv_file:
+            csv_file.write(f"{time_us}," + ",".join(f"{v:.7g}" if isinstance(v, float) else str(v) for v in values) + "\n")
+        with lock:
+            for name in plot_names:
+                if name in state["columns"]:
+                    h = history[name]
+                    h.append((time_us / 1e6, values[state["columns"].index(name)]))
+                    while h and h[-1][0] - h[0][0] > PLOT_SECONDS:
+                        h.popleft()
+
+    receiver = Receiver(on_row, lambda text: print(text, end="", flush=True))
+
+    def read_loop():
+        while True:
+            receiver.feed(device.read(4096))
+
+    def input_loop():
+        for line in sys.stdin:
+            device.write(line.encode())
+
+    device.write(f"telemetry\n{args.channels}\n".encode())
+    threading.Thread(target=read_loop, daemon=True).start()
+    threading.Thread(target=input_loop, daemon=True).start()
+
+    try:
+        if plot_names:
+            import matplotlib.animation as animation
+            import matplotlib.pyplot as plt
+
+            fig, ax = plt.subplots()
+            lines = {name: ax.plot([], [], label=name)[0] for name in plot_names}
+            ax.legend(loc="upper left")
+
+            def update(_):
+                with lock:
+                    for name, line in lines.items():
+                        if history[name]:
+                            t, v = zip(*history[name])
+                            line.set_data(t, v)
+                ax.relim()
+                ax.autoscale_view()
+                ax.set_title(f"{receiver.frames} frames, {receiver.lost} lost, {receiver.bad} corrupt")
+                return list(lines.values())
+
+            anim = animation.FuncAnimation(fig, update, interval=50, cache_frame_data=False)
+            plt.show()
+        else:
+            while True:
+                time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        device.write(b"telemetry\noff\n")
+        if csv_file:
+            csv_file.close()
+        print(f"\n{receiver.frames} frames, {receiver.lost} lost, {receiver.bad} corrupt")
+
+
+if __name__ == "__main__":
+    main()